@@ -11,6 +11,7 @@
 #include "art/Framework/Services/Registry/ServiceDefinitionMacros.h"
 #include "messagefacility/MessageLogger/MessageLogger.h"
 
+#include <algorithm>
 #include <cassert>
 
 namespace opdet {
@@ -21,7 +22,15 @@ namespace opdet {
   private:
     void doReconfigure(fhicl::ParameterSet const& p) override;
     bool doDetected(int OpChannel, const sim::OnePhoton& Phot, int& newOpChannel) const override;
+    void doDetectedBatch(int OpChannel,
+                         const sim::OnePhoton* Phots,
+                         std::size_t nPhotons,
+                         std::vector<char>& isDetected,
+                         std::vector<int>& newOpChannels) const override;
     bool doDetectedLite(int OpChannel, int& newOpChannel) const override;
+    bool doDetectionProbabilityLite(int OpChannel,
+                                    double& probability,
+                                    int& newOpChannel) const override;
 
   }; // class DefaultOpDetResponse
 
@@ -62,6 +71,17 @@ namespace opdet {
     return true;
   }
 
+  //--------------------------------------------------------------------
+  void DefaultOpDetResponse::doDetectedBatch(int OpChannel,
+                                            const sim::OnePhoton* /*Phots*/,
+                                            std::size_t nPhotons,
+                                            std::vector<char>& isDetected,
+                                            std::vector<int>& newOpChannels) const
+  {
+    std::fill_n(newOpChannels.begin(), nPhotons, OpChannel);
+    std::fill_n(isDetected.begin(), nPhotons, true);
+  }
+
   //--------------------------------------------------------------------
   bool DefaultOpDetResponse::doDetectedLite(int OpChannel, int& newOpChannel) const
   {
@@ -69,6 +89,17 @@ namespace opdet {
     return true;
   }
 
+  //--------------------------------------------------------------------
+  bool DefaultOpDetResponse::doDetectionProbabilityLite(int OpChannel,
+                                                       double& probability,
+                                                       int& newOpChannel) const
+  {
+    // doDetectedLite() accepts all photons
+    newOpChannel = OpChannel;
+    probability = 1.0;
+    return true;
+  }
+
 } // namespace
 
 DEFINE_ART_SERVICE_INTERFACE_IMPL(opdet::DefaultOpDetResponse, opdet::OpDetResponseInterface)
@@ -10,15 +10,25 @@
 
 #include "lardataobj/Simulation/SimPhotons.h"
 
+#include <algorithm>
+
 namespace opdet {
-  class MicrobooneOpDetResponse : public OpDetResponseInterface {
+  class MicrobooneOpDetResponse final : public OpDetResponseInterface {
   public:
     MicrobooneOpDetResponse(fhicl::ParameterSet const& pset);
 
   private:
     void doReconfigure(fhicl::ParameterSet const& p) override;
     bool doDetected(int OpChannel, const sim::OnePhoton& Phot, int& newOpChannel) const override;
+    void doDetectedBatch(int OpChannel,
+                         const sim::OnePhoton* Phots,
+                         std::size_t nPhotons,
+                         std::vector<char>& isDetected,
+                         std::vector<int>& newOpChannels) const override;
     bool doDetectedLite(int OpChannel, int& newOpChannel) const override;
+    bool doDetectionProbabilityLite(int OpChannel,
+                                    double& probability,
+                                    int& newOpChannel) const override;
 
     float fQE; // Quantum efficiency of tube
 
@@ -88,6 +98,22 @@ namespace opdet {
     return true;
   }
 
+  //--------------------------------------------------------------------
+  void MicrobooneOpDetResponse::doDetectedBatch(int OpChannel,
+                                               const sim::OnePhoton* Phots,
+                                               std::size_t nPhotons,
+                                               std::vector<char>& isDetected,
+                                               std::vector<int>& newOpChannels) const
+  {
+    std::fill_n(newOpChannels.begin(), nPhotons, OpChannel);
+
+    // Same wavelength acceptance as doDetected(), without per-photon calls
+    for (std::size_t i = 0; i != nPhotons; ++i) {
+      double const wavel = wavelength(Phots[i].Energy);
+      isDetected[i] = !(wavel < fWavelengthCutLow) && !(wavel > fWavelengthCutHigh);
+    }
+  }
+
   //--------------------------------------------------------------------
   bool MicrobooneOpDetResponse::doDetectedLite(int OpChannel, int& newOpChannel) const
   {
@@ -104,6 +130,17 @@ namespace opdet {
     return true;
   }
 
+  //--------------------------------------------------------------------
+  bool MicrobooneOpDetResponse::doDetectionProbabilityLite(int OpChannel,
+                                                          double& probability,
+                                                          int& newOpChannel) const
+  {
+    // doDetectedLite() accepts all photons
+    newOpChannel = OpChannel;
+    probability = 1.0;
+    return true;
+  }
+
 } // namespace
 
 DEFINE_ART_SERVICE_INTERFACE_IMPL(opdet::MicrobooneOpDetResponse, opdet::OpDetResponseInterface)
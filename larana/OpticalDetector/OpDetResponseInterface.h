@@ -23,6 +23,10 @@ namespace fhicl {
   class ParameterSet;
 }
 
+// C++ includes
+#include <cstddef>
+#include <vector>
+
 namespace opdet {
   class OpDetResponseInterface {
   public:
@@ -38,9 +42,25 @@ namespace opdet {
 
     virtual bool detected(int OpChannel, const sim::OnePhoton& Phot, int& newOpChannel) const;
     virtual bool detected(int OpChannel, const sim::OnePhoton& Phot) const;
+
+    // Same as detected() for nPhotons contiguous photons on OpChannel:
+    // isDetected[i] and newOpChannels[i] are resized to nPhotons and hold the
+    // result and readout channel of the i-th photon.
+    void detectedBatch(int OpChannel,
+                       const sim::OnePhoton* Phots,
+                       std::size_t nPhotons,
+                       std::vector<char>& isDetected,
+                       std::vector<int>& newOpChannels) const;
     virtual bool detectedLite(int OpChannel, int& newOpChannel) const;
     virtual bool detectedLite(int OpChannel) const;
 
+    // Probability that detectedLite() accepts a photon on OpChannel, for
+    // responses where it does not depend on the single photon; the readout
+    // channel must then be the same for all photons of OpChannel.
+    // Returns false if the response provides no such probability, in which
+    // case detectedLite() must be called for each photon.
+    bool detectionProbabilityLite(int OpChannel, double& probability, int& newOpChannel) const;
+
     virtual float wavelength(double energy) const;
 
   private:
@@ -50,7 +70,15 @@ namespace opdet {
     virtual int doReadoutToGeoChannel(int readoutChannel) const;
 
     virtual bool doDetected(int OpChannel, const sim::OnePhoton& Phot, int& newOpChannel) const = 0;
+    virtual void doDetectedBatch(int OpChannel,
+                                 const sim::OnePhoton* Phots,
+                                 std::size_t nPhotons,
+                                 std::vector<char>& isDetected,
+                                 std::vector<int>& newOpChannels) const;
     virtual bool doDetectedLite(int OpChannel, int& newOpChannel) const = 0;
+    virtual bool doDetectionProbabilityLite(int OpChannel,
+                                            double& probability,
+                                            int& newOpChannel) const;
 
   }; // class OpDetResponse
 
@@ -100,6 +128,30 @@ namespace opdet {
     return doDetected(OpChannel, Phot, newOpChannel);
   }
 
+  //-------------------------------------------------------------------------------------------------------------
+  inline void OpDetResponseInterface::detectedBatch(int OpChannel,
+                                                    const sim::OnePhoton* Phots,
+                                                    std::size_t nPhotons,
+                                                    std::vector<char>& isDetected,
+                                                    std::vector<int>& newOpChannels) const
+  {
+    isDetected.resize(nPhotons);
+    newOpChannels.resize(nPhotons);
+    doDetectedBatch(OpChannel, Phots, nPhotons, isDetected, newOpChannels);
+  }
+
+  //-------------------------------------------------------------------------------------------------------------
+  inline void OpDetResponseInterface::doDetectedBatch(int OpChannel,
+                                                      const sim::OnePhoton* Phots,
+                                                      std::size_t nPhotons,
+                                                      std::vector<char>& isDetected,
+                                                      std::vector<int>& newOpChannels) const
+  {
+    // By default ask for each photon in turn
+    for (std::size_t i = 0; i != nPhotons; ++i)
+      isDetected[i] = doDetected(OpChannel, Phots[i], newOpChannels[i]);
+  }
+
   //-------------------------------------------------------------------------------------------------------------
   inline bool OpDetResponseInterface::detectedLite(int OpChannel, int& newOpChannel) const
   {
@@ -113,6 +165,23 @@ namespace opdet {
     return doDetectedLite(OpChannel, newOpChannel);
   }
 
+  //-------------------------------------------------------------------------------------------------------------
+  inline bool OpDetResponseInterface::detectionProbabilityLite(int OpChannel,
+                                                               double& probability,
+                                                               int& newOpChannel) const
+  {
+    return doDetectionProbabilityLite(OpChannel, probability, newOpChannel);
+  }
+
+  //-------------------------------------------------------------------------------------------------------------
+  inline bool OpDetResponseInterface::doDetectionProbabilityLite(int /* OpChannel */,
+                                                                 double& /* probability */,
+                                                                 int& /* newOpChannel */) const
+  {
+    // By default photons must be sampled one by one
+    return false;
+  }
+
   //-------------------------------------------------------------------------------------------------------------
   inline float OpDetResponseInterface::wavelength(double energy) const
   {
@@ -23,10 +23,15 @@
 #include "lardataobj/RecoBase/OpFlash.h"
 #include "lardataobj/RecoBase/OpHit.h"
 
+#include "cetlib_except/exception.h"
+
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <exception>
 #include <iostream>
-#include <numeric> // std::iota()
+#include <iterator> // std::prev()
+#include <numeric>  // std::iota(), std::partial_sum()
 
 namespace opdet {
 
@@ -67,100 +72,75 @@ namespace opdet {
                       detinfo::DetectorClocksData const& ClocksData,
                       float const TrigCoinc)
   {
-    // Initial size for accumulators - will be automatically extended if needed
-    int initialsize = 6400;
-
-    // These are the accumulators which will hold broad-binned light yields
-    std::vector<double> Binned1(initialsize);
-    std::vector<double> Binned2(initialsize);
-
-    // These will keep track of which pulses put activity in each bin
-    std::vector<std::vector<int>> Contributors1(initialsize);
-    std::vector<std::vector<int>> Contributors2(initialsize);
-
-    // These will keep track of where we have met the flash condition
-    // (in order to prevent second pointless loop)
-    std::vector<int> FlashesInAccumulator1;
-    std::vector<int> FlashesInAccumulator2;
+    FlashFinderScratch scratch;
+    RunFlashFinder(HitVector,
+                   FlashVector,
+                   AssocList,
+                   BinWidth,
+                   geom,
+                   FlashThreshold,
+                   WidthTolerance,
+                   ClocksData,
+                   TrigCoinc,
+                   scratch);
+  }
 
+  //----------------------------------------------------------------------------
+  void RunFlashFinder(std::vector<recob::OpHit> const& HitVector,
+                      std::vector<recob::OpFlash>& FlashVector,
+                      std::vector<std::vector<int>>& AssocList,
+                      double const BinWidth,
+                      geo::GeometryCore const& geom,
+                      float const FlashThreshold,
+                      float const WidthTolerance,
+                      detinfo::DetectorClocksData const& ClocksData,
+                      float const TrigCoinc,
+                      FlashFinderScratch& scratch,
+                      OpChannelGeometryTable const* ChannelGeometry,
+                      double const LateLightHorizon)
+  {
     double minTime = std::numeric_limits<float>::max();
     for (auto const& hit : HitVector)
       if (hit.PeakTime() < minTime) minTime = hit.PeakTime();
 
-    for (auto const& hit : HitVector) {
-
-      double peakTime = hit.PeakTime();
-
-      unsigned int AccumIndex1 = GetAccumIndex(peakTime, minTime, BinWidth, 0.0);
+    // These are the accumulators which will hold broad-binned light yields,
+    // the second one staggered by half a bin
+    FillAccumulator(HitVector, minTime, BinWidth, 0.0, FlashThreshold, scratch.Accumulators[0]);
+    FillAccumulator(
+      HitVector, minTime, BinWidth, BinWidth / 2.0, FlashThreshold, scratch.Accumulators[1]);
 
-      unsigned int AccumIndex2 = GetAccumIndex(peakTime, minTime, BinWidth, BinWidth / 2.0);
+    //if (Frame == 1) writeHistogram(scratch.Accumulators[0].Binned);
 
-      // Extend accumulators if needed (2 always larger than 1)
-      if (AccumIndex2 >= Binned1.size()) {
-        std::cout << "Extending vectors to " << AccumIndex2 * 1.2 << std::endl;
-        Binned1.resize(AccumIndex2 * 1.2);
-        Binned2.resize(AccumIndex2 * 1.2);
-        Contributors1.resize(AccumIndex2 * 1.2);
-        Contributors2.resize(AccumIndex2 * 1.2);
-      }
-
-      size_t const hitIndex = &hit - &HitVector[0];
-
-      FillAccumulator(AccumIndex1,
-                      hitIndex,
-                      hit.PE(),
-                      FlashThreshold,
-                      Binned1,
-                      Contributors1,
-                      FlashesInAccumulator1);
-
-      FillAccumulator(AccumIndex2,
-                      hitIndex,
-                      hit.PE(),
-                      FlashThreshold,
-                      Binned2,
-                      Contributors2,
-                      FlashesInAccumulator2);
-
-    } // End loop over hits
-
-    // Now start to create flashes.
-    // First, need vector to keep track of which hits belong to which flashes
-    std::vector<std::vector<int>> HitsPerFlash;
-
-    //if (Frame == 1) writeHistogram(Binned1);
-
-    AssignHitsToFlash(FlashesInAccumulator1,
-                      FlashesInAccumulator2,
-                      Binned1,
-                      Binned2,
-                      Contributors1,
-                      Contributors2,
-                      HitVector,
-                      HitsPerFlash,
-                      FlashThreshold);
+    // Now start to create flashes, keeping track of which hits belong to them
+    AssignHitsToFlash(HitVector, FlashThreshold, scratch);
 
     // Now we do the fine grained part.
     // Subdivide each flash into sub-flashes with overlaps within hit widths
     // (assumed wider than photon travel time)
     std::vector<std::vector<int>> RefinedHitsPerFlash;
-    for (auto const& HitsThisFlash : HitsPerFlash)
-      RefineHitsInFlash(
-        HitsThisFlash, HitVector, RefinedHitsPerFlash, WidthTolerance, FlashThreshold);
+    scratch.HitsUsed.assign(HitVector.size(), false);
+    for (std::size_t iFlash = 0; iFlash + 1 < scratch.FlashHitStart.size(); ++iFlash)
+      RefineHitsInFlash(scratch.FlashHits.data() + scratch.FlashHitStart[iFlash],
+                        scratch.FlashHits.data() + scratch.FlashHitStart[iFlash + 1],
+                        HitVector,
+                        RefinedHitsPerFlash,
+                        WidthTolerance,
+                        FlashThreshold,
+                        scratch);
 
     // Now we have all our hits assigned to a flash.
     // Make the recob::OpFlash objects
     for (auto const& HitsPerFlashVec : RefinedHitsPerFlash)
-      ConstructFlash(HitsPerFlashVec, HitVector, FlashVector, geom, ClocksData, TrigCoinc);
+      ConstructFlash(
+        HitsPerFlashVec, HitVector, FlashVector, geom, ClocksData, TrigCoinc, ChannelGeometry);
 
-    RemoveLateLight(FlashVector, RefinedHitsPerFlash);
+    RemoveLateLight(FlashVector, RefinedHitsPerFlash, LateLightHorizon);
 
     //checkOnBeamFlash(FlashVector);
 
     // Finally, write the association list.
-    // back_inserter tacks the result onto the end of AssocList
     for (auto& HitIndicesThisFlash : RefinedHitsPerFlash)
-      AssocList.push_back(HitIndicesThisFlash);
+      AssocList.push_back(std::move(HitIndicesThisFlash));
 
   } // End RunFlashFinder
 
@@ -368,17 +348,132 @@ namespace opdet {
   } // End CheckAndStoreFlash
 
   //----------------------------------------------------------------------------
-  void RefineHitsInFlash(std::vector<int> const& HitsThisFlash,
+  void FillAccumulator(std::vector<recob::OpHit> const& HitVector,
+                       double const MinTime,
+                       double const BinWidth,
+                       double const BinOffset,
+                       float const FlashThreshold,
+                       FlashFinderScratch::Accumulator& Accum)
+  {
+    std::size_t NBins = 0;
+    Accum.HitBin.resize(HitVector.size());
+    for (std::size_t HitIndex = 0; HitIndex != HitVector.size(); ++HitIndex) {
+      unsigned int const AccumIndex =
+        GetAccumIndex(HitVector[HitIndex].PeakTime(), MinTime, BinWidth, BinOffset);
+      Accum.HitBin[HitIndex] = AccumIndex;
+      NBins = std::max(NBins, static_cast<std::size_t>(AccumIndex) + 1);
+    }
+
+    Accum.Binned.assign(NBins, 0.0);
+    Accum.ContributorStart.assign(NBins + 1, 0);
+    Accum.FlashesInAccumulator.clear();
+
+    // Sum the light and count the contributors of each bin; the flash
+    // condition is tested hit by hit, in the same order as `FillAccumulator()`
+    for (std::size_t HitIndex = 0; HitIndex != HitVector.size(); ++HitIndex) {
+      unsigned int const AccumIndex = Accum.HitBin[HitIndex];
+      double const PE = HitVector[HitIndex].PE();
+
+      ++Accum.ContributorStart[AccumIndex + 1];
+      Accum.Binned[AccumIndex] += PE;
+
+      // If this wasn't a flash already, add it to the list
+      if (Accum.Binned[AccumIndex] >= FlashThreshold &&
+          (Accum.Binned[AccumIndex] - PE) < FlashThreshold)
+        Accum.FlashesInAccumulator.push_back(AccumIndex);
+    }
+
+    // Counting sort of the hits by bin (stable, so hits stay in input order)
+    std::partial_sum(Accum.ContributorStart.begin(),
+                     Accum.ContributorStart.end(),
+                     Accum.ContributorStart.begin());
+    Accum.Contributors.resize(HitVector.size());
+    for (std::size_t HitIndex = 0; HitIndex != HitVector.size(); ++HitIndex)
+      Accum.Contributors[Accum.ContributorStart[Accum.HitBin[HitIndex]]++] = HitIndex;
+
+    // Each start has now moved to the next bin start: shift them back
+    std::copy_backward(Accum.ContributorStart.begin(),
+                       std::prev(Accum.ContributorStart.end()),
+                       Accum.ContributorStart.end());
+    Accum.ContributorStart[0] = 0;
+  }
+
+  //----------------------------------------------------------------------------
+  void AssignHitsToFlash(std::vector<recob::OpHit> const& HitVector,
+                         float const FlashThreshold,
+                         FlashFinderScratch& scratch)
+  {
+    // Sort all the flashes found by size; flashes of the same size are taken
+    // from the first accumulator first, in the order they were found
+    auto& FlashesBySize = scratch.FlashesBySize;
+    FlashesBySize.clear();
+    for (unsigned int Accumulator = 0; Accumulator != scratch.Accumulators.size(); ++Accumulator) {
+      auto const& Accum = scratch.Accumulators[Accumulator];
+      for (auto const& Bin : Accum.FlashesInAccumulator)
+        FlashesBySize.push_back({Accum.Binned[Bin], Accumulator, Bin});
+    }
+    std::stable_sort(FlashesBySize.begin(),
+                     FlashesBySize.end(),
+                     [](FlashFinderScratch::FlashCandidate const& a,
+                        FlashFinderScratch::FlashCandidate const& b) { return a.PE > b.PE; });
+
+    // This keeps track of which hits are claimed by which flash
+    auto& HitClaimedByFlash = scratch.HitClaimedByFlash;
+    HitClaimedByFlash.assign(HitVector.size(), -1);
+
+    auto& FlashHitStart = scratch.FlashHitStart;
+    auto& FlashHits = scratch.FlashHits;
+    FlashHitStart.assign(1, 0);
+    FlashHits.clear();
+
+    // Walk from largest to smallest, claiming hits.
+    // The biggest flash always gets dibbs.
+    for (auto const& Flash : FlashesBySize) {
+
+      auto const& Accum = scratch.Accumulators[Flash.Accumulator];
+
+      // Collect the hits of the bin which are still unclaimed
+      std::size_t const FirstHit = FlashHits.size();
+      double PE = 0;
+      for (std::size_t iHit = Accum.ContributorStart[Flash.Bin];
+           iHit != Accum.ContributorStart[Flash.Bin + 1];
+           ++iHit) {
+        int const HitIndex = Accum.Contributors[iHit];
+        if (HitClaimedByFlash[HitIndex] != -1) continue;
+        FlashHits.push_back(HitIndex);
+        PE += HitVector[HitIndex].PE();
+      }
+
+      if (PE < FlashThreshold) {
+        FlashHits.resize(FirstHit);
+        continue;
+      }
+
+      // Add the flash to the list, and claim all its hits
+      int const FlashIndex = FlashHitStart.size() - 1;
+      FlashHitStart.push_back(FlashHits.size());
+      for (std::size_t iHit = FirstHit; iHit != FlashHits.size(); ++iHit)
+        HitClaimedByFlash[FlashHits[iHit]] = FlashIndex;
+
+    } // End loop over sorted flashes
+
+  } // End AssignHitsToFlash
+
+  //----------------------------------------------------------------------------
+  void RefineHitsInFlash(int const* HitsBegin,
+                         int const* HitsEnd,
                          std::vector<recob::OpHit> const& HitVector,
                          std::vector<std::vector<int>>& RefinedHitsPerFlash,
                          float const WidthTolerance,
-                         float const FlashThreshold)
+                         float const FlashThreshold,
+                         FlashFinderScratch& scratch)
   {
-    // Sort the hits by their size using map
-    // HitsBySize[HitSize] = [hit1, hit2 ...]
-    std::map<double, std::vector<int>, std::greater<double>> HitsBySize;
-    for (auto const& HitID : HitsThisFlash)
-      HitsBySize[HitVector.at(HitID).PE()].push_back(HitID);
+    // Sort the hits by their size (hits of the same size keep their order)
+    auto& HitsBySize = scratch.HitsBySize;
+    HitsBySize.assign(HitsBegin, HitsEnd);
+    std::stable_sort(HitsBySize.begin(), HitsBySize.end(), [&HitVector](int a, int b) {
+      return HitVector[a].PE() > HitVector[b].PE();
+    });
 
     // Heres what we do:
     //  1.Start with the biggest remaining hit
@@ -387,27 +482,30 @@ namespace opdet {
     //  4.Collect again
     //  5.Repeat until no new hits collected
     //  6.Remove these hits from consideration and repeat
+    //
+    // All the hits before the seed are used, and the hits released by
+    // `CheckAndStoreFlash()` always come after it: the search for the next
+    // seed and for new hits can start from the current seed.
 
-    std::vector<bool> HitsUsed(HitVector.size(), false);
+    auto& HitsUsed = scratch.HitsUsed;
+    auto& HitsThisRefinedFlash = scratch.HitsThisRefinedFlash;
     double PEAccumulated, FlashMaxTime, FlashMinTime;
-    std::vector<int> HitsThisRefinedFlash;
 
+    auto Seed = HitsBySize.cbegin();
     while (true) {
 
-      HitsThisRefinedFlash.clear();
-      PEAccumulated = 0;
-      FlashMaxTime = 0;
-      FlashMinTime = 0;
+      while (Seed != HitsBySize.cend() && HitsUsed[*Seed])
+        ++Seed;
 
-      FindSeedHit(HitsBySize,
-                  HitsUsed,
-                  HitVector,
-                  HitsThisRefinedFlash,
-                  PEAccumulated,
-                  FlashMaxTime,
-                  FlashMinTime);
+      if (Seed == HitsBySize.cend()) break;
 
-      if (HitsThisRefinedFlash.size() == 0) return;
+      recob::OpHit const& SeedHit = HitVector[*Seed];
+      PEAccumulated = SeedHit.PE();
+      FlashMaxTime = SeedHit.PeakTime() + 0.5 * SeedHit.Width();
+      FlashMinTime = SeedHit.PeakTime() - 0.5 * SeedHit.Width();
+
+      HitsThisRefinedFlash.assign(1, *Seed);
+      HitsUsed[*Seed] = true;
 
       // Start this at zero to do the while at least once
       size_t NHitsThisRefinedFlash = 0;
@@ -417,16 +515,15 @@ namespace opdet {
       while (NHitsThisRefinedFlash < HitsThisRefinedFlash.size()) {
         NHitsThisRefinedFlash = HitsThisRefinedFlash.size();
 
-        for (auto const& itHit : HitsBySize)
-          for (auto const& HitID : itHit.second)
-            AddHitToFlash(HitID,
-                          HitsUsed,
-                          HitVector.at(HitID),
-                          WidthTolerance,
-                          HitsThisRefinedFlash,
-                          PEAccumulated,
-                          FlashMaxTime,
-                          FlashMinTime);
+        for (auto itHit = Seed; itHit != HitsBySize.cend(); ++itHit)
+          AddHitToFlash(*itHit,
+                        HitsUsed,
+                        HitVector[*itHit],
+                        WidthTolerance,
+                        HitsThisRefinedFlash,
+                        PEAccumulated,
+                        FlashMaxTime,
+                        FlashMinTime);
       }
 
       // We did our collecting, now check if the flash is
@@ -436,8 +533,30 @@ namespace opdet {
 
     } // End while there are hits left
 
+    // Leave the hit flags clean for the next flash
+    for (auto const& HitID : HitsBySize)
+      HitsUsed[HitID] = false;
+
   } // End RefineHitsInFlash
 
+  //----------------------------------------------------------------------------
+  void RefineHitsInFlash(std::vector<int> const& HitsThisFlash,
+                         std::vector<recob::OpHit> const& HitVector,
+                         std::vector<std::vector<int>>& RefinedHitsPerFlash,
+                         float const WidthTolerance,
+                         float const FlashThreshold)
+  {
+    FlashFinderScratch scratch;
+    scratch.HitsUsed.assign(HitVector.size(), false);
+    RefineHitsInFlash(HitsThisFlash.data(),
+                      HitsThisFlash.data() + HitsThisFlash.size(),
+                      HitVector,
+                      RefinedHitsPerFlash,
+                      WidthTolerance,
+                      FlashThreshold,
+                      scratch);
+  }
+
   //----------------------------------------------------------------------------
   void AddHitContribution(recob::OpHit const& currentHit,
                           double& MaxTime,
@@ -494,6 +613,84 @@ namespace opdet {
     sumz2 += PEThisHit * xyz.Z() * xyz.Z();
   }
 
+  //----------------------------------------------------------------------------
+  void GetHitGeometryInfo(recob::OpHit const& currentHit,
+                          OpChannelGeometryTable const& ChannelGeometry,
+                          geo::GeometryCore const& geom,
+                          std::vector<double>& sumw,
+                          std::vector<double>& sumw2,
+                          double& sumy,
+                          double& sumy2,
+                          double& sumz,
+                          double& sumz2)
+  {
+    auto const channel = static_cast<std::size_t>(currentHit.OpChannel());
+    if (channel >= ChannelGeometry.Valid.size() || !ChannelGeometry.Valid[channel]) {
+      GetHitGeometryInfo(currentHit, geom, sumw, sumw2, sumy, sumy2, sumz, sumz2);
+      return;
+    }
+
+    double const y = ChannelGeometry.CenterY[channel];
+    double const z = ChannelGeometry.CenterZ[channel];
+    double PEThisHit = currentHit.PE();
+
+    // if the point does not fall into any TPC,
+    // it does not contribute to the average wire position
+    if (ChannelGeometry.InTPC[channel]) {
+      unsigned int const* wires = &ChannelGeometry.NearestWire[channel * ChannelGeometry.Nplanes];
+      for (size_t p = 0; p != ChannelGeometry.Nplanes; ++p) {
+        unsigned int w = wires[p];
+        sumw.at(p) += PEThisHit * w;
+        sumw2.at(p) += PEThisHit * w * w;
+      }
+    } // if we found the TPC
+    sumy += PEThisHit * y;
+    sumy2 += PEThisHit * y * y;
+    sumz += PEThisHit * z;
+    sumz2 += PEThisHit * z * z;
+  }
+
+  //----------------------------------------------------------------------------
+  OpChannelGeometryTable MakeOpChannelGeometryTable(geo::GeometryCore const& geom)
+  {
+    OpChannelGeometryTable table;
+
+    std::size_t const NChannels = geom.MaxOpChannel() + 1;
+    table.Nplanes = geom.Nplanes();
+    table.Valid.assign(NChannels, false);
+    table.InTPC.assign(NChannels, false);
+    table.CenterY.assign(NChannels, 0.0);
+    table.CenterZ.assign(NChannels, 0.0);
+    table.NearestWire.assign(NChannels * table.Nplanes, 0);
+
+    for (std::size_t channel = 0; channel != NChannels; ++channel) {
+      if (!geom.IsValidOpChannel(channel)) continue;
+
+      // channels the geometry can't describe are not cached, so that any
+      // error is reported when (and if) they are used, as without the table
+      try {
+        auto const xyz = geom.OpDetGeoFromOpChannel(channel).GetCenter();
+        table.CenterY[channel] = xyz.Y();
+        table.CenterZ[channel] = xyz.Z();
+
+        geo::TPCID tpc = geom.FindTPCAtPosition(xyz);
+        if (tpc.isValid) {
+          for (size_t p = 0; p != table.Nplanes; ++p) {
+            geo::PlaneID const planeID(tpc, p);
+            table.NearestWire[channel * table.Nplanes + p] = geom.NearestWireID(xyz, planeID).Wire;
+          }
+          table.InTPC[channel] = true;
+        }
+      }
+      catch (std::exception const&) {
+        continue;
+      }
+      table.Valid[channel] = true;
+    } // for channels
+
+    return table;
+  }
+
   //----------------------------------------------------------------------------
   double CalculateWidth(double const sum, double const sum_squared, double const weights_sum)
   {
@@ -509,7 +706,8 @@ namespace opdet {
                       std::vector<recob::OpFlash>& FlashVector,
                       geo::GeometryCore const& geom,
                       detinfo::DetectorClocksData const& ClocksData,
-                      float const TrigCoinc)
+                      float const TrigCoinc,
+                      OpChannelGeometryTable const* ChannelGeometry)
   {
     double MaxTime = -std::numeric_limits<double>::max();
     double MinTime = std::numeric_limits<double>::max();
@@ -531,7 +729,11 @@ namespace opdet {
     for (auto const& HitID : HitsPerFlashVec) {
       AddHitContribution(
         HitVector.at(HitID), MaxTime, MinTime, AveTime, FastToTotal, AveAbsTime, TotalPE, PEs);
-      GetHitGeometryInfo(HitVector.at(HitID), geom, sumw, sumw2, sumy, sumy2, sumz, sumz2);
+      if (ChannelGeometry)
+        GetHitGeometryInfo(
+          HitVector.at(HitID), *ChannelGeometry, geom, sumw, sumw2, sumy, sumy2, sumz, sumz2);
+      else
+        GetHitGeometryInfo(HitVector.at(HitID), geom, sumw, sumw2, sumy, sumy2, sumz, sumz2);
     }
 
     AveTime /= TotalPE;
@@ -602,26 +804,41 @@ namespace opdet {
   //----------------------------------------------------------------------------
   void MarkFlashesForRemoval(std::vector<recob::OpFlash> const& FlashVector,
                              size_t const BeginFlash,
-                             std::vector<bool>& MarkedForRemoval)
+                             std::vector<bool>& MarkedForRemoval,
+                             double const LateLightHorizon)
   {
-    for (size_t iFlash = BeginFlash; iFlash != FlashVector.size(); ++iFlash) {
+    // Cache the flash quantities (the total PE is summed on each request)
+    size_t const NFlashes = FlashVector.size() - BeginFlash;
+    std::vector<double> Times(NFlashes), PEs(NFlashes), Widths(NFlashes);
+    for (size_t iFlash = 0; iFlash != NFlashes; ++iFlash) {
+      recob::OpFlash const& flash = FlashVector[BeginFlash + iFlash];
+      Times[iFlash] = flash.Time();
+      PEs[iFlash] = flash.TotalPE();
+      Widths[iFlash] = flash.TimeWidth();
+    }
+
+    for (size_t iFlash = 0; iFlash != NFlashes; ++iFlash) {
+
+      double iTime = Times[iFlash];
+      double iPE = PEs[iFlash];
+      double iWidth = Widths[iFlash];
 
-      double iTime = FlashVector.at(iFlash).Time();
-      double iPE = FlashVector.at(iFlash).TotalPE();
-      double iWidth = FlashVector.at(iFlash).TimeWidth();
+      for (size_t jFlash = iFlash + 1; jFlash != NFlashes; ++jFlash) {
 
-      for (size_t jFlash = iFlash + 1; jFlash != FlashVector.size(); ++jFlash) {
+        double jTime = Times[jFlash];
 
-        if (MarkedForRemoval.at(jFlash - BeginFlash)) continue;
+        // Flashes are sorted by time: all the next ones are beyond the horizon
+        if (jTime - iTime > LateLightHorizon) break;
 
-        double jTime = FlashVector.at(jFlash).Time();
-        double jPE = FlashVector.at(jFlash).TotalPE();
-        double jWidth = FlashVector.at(jFlash).TimeWidth();
+        if (MarkedForRemoval.at(jFlash)) continue;
+
+        double jPE = PEs[jFlash];
+        double jWidth = Widths[jFlash];
 
         // If smaller than, or within 2sigma of expectation,
         // attribute to late light and toss out
         if (GetLikelihoodLateLight(iPE, iTime, iWidth, jPE, jTime, jWidth) < 3.0)
-          MarkedForRemoval.at(jFlash - BeginFlash) = true;
+          MarkedForRemoval.at(jFlash) = true;
       }
     }
   }
@@ -632,16 +849,26 @@ namespace opdet {
                                 size_t const BeginFlash,
                                 std::vector<std::vector<int>>& RefinedHitsPerFlash)
   {
-    for (int iFlash = MarkedForRemoval.size() - 1; iFlash != -1; --iFlash)
-      if (MarkedForRemoval.at(iFlash)) {
-        RefinedHitsPerFlash.erase(RefinedHitsPerFlash.begin() + iFlash);
-        FlashVector.erase(FlashVector.begin() + BeginFlash + iFlash);
+    // Move the flashes to keep forward in a single pass, then drop the rest
+    size_t NKept = 0;
+    for (size_t iFlash = 0; iFlash != MarkedForRemoval.size(); ++iFlash) {
+      if (MarkedForRemoval[iFlash]) continue;
+      if (NKept != iFlash) {
+        RefinedHitsPerFlash[NKept] = std::move(RefinedHitsPerFlash[iFlash]);
+        FlashVector[BeginFlash + NKept] = std::move(FlashVector[BeginFlash + iFlash]);
       }
+      ++NKept;
+    }
+    RefinedHitsPerFlash.erase(RefinedHitsPerFlash.begin() + NKept,
+                              RefinedHitsPerFlash.begin() + MarkedForRemoval.size());
+    FlashVector.erase(FlashVector.begin() + BeginFlash + NKept,
+                      FlashVector.begin() + BeginFlash + MarkedForRemoval.size());
   }
 
   //----------------------------------------------------------------------------
   void RemoveLateLight(std::vector<recob::OpFlash>& FlashVector,
-                       std::vector<std::vector<int>>& RefinedHitsPerFlash)
+                       std::vector<std::vector<int>>& RefinedHitsPerFlash,
+                       double const LateLightHorizon)
   {
     std::vector<bool> MarkedForRemoval(RefinedHitsPerFlash.size(), false);
 
@@ -652,17 +879,390 @@ namespace opdet {
     // Determine the sort of FlashVector starting at BeginFlash
     auto sort_order = sort_permutation(FlashVector, BeginFlash, sort_flash_by_time);
 
-    // Sort the RefinedHitsPerFlash in the same way as tail end of FlashVector
+    // Sort the RefinedHitsPerFlash and the tail end of FlashVector in the
+    // same way (flashes with the same time keep their hits)
     apply_permutation(RefinedHitsPerFlash, sort_order);
+    apply_permutation(FlashVector, sort_order, BeginFlash);
 
-    std::sort(FlashVector.begin() + BeginFlash, FlashVector.end(), sort_flash_by_time);
-
-    MarkFlashesForRemoval(FlashVector, BeginFlash, MarkedForRemoval);
+    MarkFlashesForRemoval(FlashVector, BeginFlash, MarkedForRemoval, LateLightHorizon);
 
     RemoveFlashesFromVectors(MarkedForRemoval, FlashVector, BeginFlash, RefinedHitsPerFlash);
 
   } // End RemoveLateLight
 
+  //----------------------------------------------------------------------------
+  StreamingFlashFinder::StreamingFlashFinder(double const BinWidth,
+                                             float const FlashThreshold,
+                                             float const WidthTolerance,
+                                             float const TrigCoinc,
+                                             double const LateLightHorizon)
+    : fBinWidth{BinWidth}
+    , fFlashThreshold{FlashThreshold}
+    , fWidthTolerance{WidthTolerance}
+    , fTrigCoinc{TrigCoinc}
+    , fLateLightHorizon{LateLightHorizon}
+  {}
+
+  //----------------------------------------------------------------------------
+  void StreamingFlashFinder::Reset()
+  {
+    fStarted = false;
+    fNextHitIndex = 0;
+    fNCrossings = 0;
+    for (auto& Accum : fAccumulators) {
+      Accum.Base = 0;
+      Accum.Binned.clear();
+    }
+    fCandidates.clear();
+    fHits.clear();
+    fHitIndices.clear();
+    fHitBins.clear();
+    fPending.clear();
+    fHistory.clear();
+  }
+
+  //----------------------------------------------------------------------------
+  void StreamingFlashFinder::AddHits(std::vector<recob::OpHit> const& HitVector,
+                                     std::vector<recob::OpFlash>& FlashVector,
+                                     std::vector<std::vector<int>>& AssocList,
+                                     geo::GeometryCore const& geom,
+                                     detinfo::DetectorClocksData const& ClocksData,
+                                     OpChannelGeometryTable const* ChannelGeometry)
+  {
+    AddHits(
+      HitVector, FlashVector, AssocList, GeometryFlashMaker(geom, ClocksData, ChannelGeometry));
+  }
+
+  //----------------------------------------------------------------------------
+  void StreamingFlashFinder::AddHits(std::vector<recob::OpHit> const& HitVector,
+                                     std::vector<recob::OpFlash>& FlashVector,
+                                     std::vector<std::vector<int>>& AssocList,
+                                     FlashMaker_t const& MakeFlash)
+  {
+    if (HitVector.empty()) return;
+
+    double minTime = std::numeric_limits<float>::max();
+    double maxTime = -std::numeric_limits<double>::max();
+    for (auto const& hit : HitVector) {
+      minTime = std::min(minTime, hit.PeakTime());
+      maxTime = std::max(maxTime, hit.PeakTime());
+    }
+
+    if (!fStarted) {
+      fMinTime = minTime;
+      fWatermark = minTime;
+      fStarted = true;
+    }
+    else if (minTime < fWatermark) {
+      throw cet::exception("StreamingFlashFinder")
+        << "Hit at time " << minTime << " is earlier than hits already processed (up to "
+        << fWatermark << "): chunks must be in time order.\n";
+    }
+
+    // Fill the accumulators, keeping track of the bins meeting the flash condition
+    for (auto const& hit : HitVector) {
+
+      double const PE = hit.PE();
+      std::array<unsigned int, 2> const Bins{
+        GetAccumIndex(hit.PeakTime(), fMinTime, fBinWidth, 0.0),
+        GetAccumIndex(hit.PeakTime(), fMinTime, fBinWidth, fBinWidth / 2.0)};
+
+      for (unsigned int iAccum = 0; iAccum != fAccumulators.size(); ++iAccum) {
+        Accumulator& Accum = fAccumulators[iAccum];
+        std::size_t const Bin = Bins[iAccum] - Accum.Base;
+        if (Bin >= Accum.Binned.size()) Accum.Binned.resize(Bin + 1, 0.0);
+
+        Accum.Binned[Bin] += PE;
+
+        // If this wasn't a flash already, add it to the list
+        if (Accum.Binned[Bin] >= fFlashThreshold && (Accum.Binned[Bin] - PE) < fFlashThreshold)
+          fCandidates.push_back({iAccum, Bins[iAccum], fNCrossings++});
+      }
+
+      fHits.push_back(hit);
+      fHitIndices.push_back(fNextHitIndex++);
+      fHitBins.push_back(Bins);
+    }
+
+    fWatermark = std::max(fWatermark, maxTime);
+
+    Process(false, FlashVector, AssocList, MakeFlash);
+  }
+
+  //----------------------------------------------------------------------------
+  void StreamingFlashFinder::Finish(std::vector<recob::OpFlash>& FlashVector,
+                                    std::vector<std::vector<int>>& AssocList,
+                                    geo::GeometryCore const& geom,
+                                    detinfo::DetectorClocksData const& ClocksData,
+                                    OpChannelGeometryTable const* ChannelGeometry)
+  {
+    Finish(FlashVector, AssocList, GeometryFlashMaker(geom, ClocksData, ChannelGeometry));
+  }
+
+  //----------------------------------------------------------------------------
+  void StreamingFlashFinder::Finish(std::vector<recob::OpFlash>& FlashVector,
+                                    std::vector<std::vector<int>>& AssocList,
+                                    FlashMaker_t const& MakeFlash)
+  {
+    if (fStarted) Process(true, FlashVector, AssocList, MakeFlash);
+    Reset();
+  }
+
+  //----------------------------------------------------------------------------
+  StreamingFlashFinder::FlashMaker_t StreamingFlashFinder::GeometryFlashMaker(
+    geo::GeometryCore const& geom,
+    detinfo::DetectorClocksData const& ClocksData,
+    OpChannelGeometryTable const* ChannelGeometry) const
+  {
+    return [&geom, &ClocksData, ChannelGeometry, TrigCoinc = fTrigCoinc](
+             std::vector<int> const& HitsPerFlashVec,
+             std::vector<recob::OpHit> const& HitVector,
+             std::vector<recob::OpFlash>& FlashVector) {
+      ConstructFlash(
+        HitsPerFlashVec, HitVector, FlashVector, geom, ClocksData, TrigCoinc, ChannelGeometry);
+    };
+  }
+
+  //----------------------------------------------------------------------------
+  void StreamingFlashFinder::Process(bool const final,
+                                     std::vector<recob::OpFlash>& FlashVector,
+                                     std::vector<std::vector<int>>& AssocList,
+                                     FlashMaker_t const& MakeFlash)
+  {
+    std::int64_t const DoneEnd = RefineCompleteFlashes(final);
+
+    // Construct the new flashes, with the global indices of their hits
+    fNewFlashes.clear();
+    for (auto& HitsPerFlashVec : fRefinedHitsPerFlash) {
+      MakeFlash(HitsPerFlashVec, fHits, fNewFlashes);
+      for (auto& HitIndex : HitsPerFlashVec)
+        HitIndex = fHitIndices[HitIndex];
+      fPending.push_back({std::move(fNewFlashes.back()), std::move(HitsPerFlashVec)});
+    }
+
+    ReleaseFlashes(final, DoneEnd, FlashVector, AssocList);
+
+    if (!final) DropCompleted(DoneEnd);
+  }
+
+  //----------------------------------------------------------------------------
+  std::int64_t StreamingFlashFinder::RefineCompleteFlashes(bool const final)
+  {
+    // Positions are in units of half a bin: bin k of the first accumulator
+    // covers [2k, 2k+2), and bin k of the second one covers [2k-1, 2k+1).
+    // Two flash bins can share hits only if they overlap; groups of
+    // overlapping flash bins claim their hits independently of each other.
+    auto const Start = [](Candidate const& cand) -> std::int64_t {
+      return 2 * static_cast<std::int64_t>(cand.Bin) - cand.Accumulator;
+    };
+
+    fRefinedHitsPerFlash.clear();
+
+    // The bins containing the watermark and later may still receive hits
+    std::int64_t OpenStart = std::numeric_limits<std::int64_t>::max();
+    if (!final) {
+      std::int64_t const OpenBin1 = GetAccumIndex(fWatermark, fMinTime, fBinWidth, 0.0);
+      std::int64_t const OpenBin2 =
+        GetAccumIndex(fWatermark, fMinTime, fBinWidth, fBinWidth / 2.0);
+      OpenStart = std::min(2 * OpenBin1, 2 * OpenBin2 - 1);
+    }
+
+    // Group the flash bins; a group is complete if it ends before the open bins
+    std::sort(fCandidates.begin(),
+              fCandidates.end(),
+              [&Start](Candidate const& a, Candidate const& b) { return Start(a) < Start(b); });
+    fComponentEnd.clear();
+    for (std::size_t iCand = 0; iCand != fCandidates.size();) {
+      std::int64_t End = Start(fCandidates[iCand]) + 2;
+      std::size_t iEnd = iCand + 1;
+      for (; iEnd != fCandidates.size() && Start(fCandidates[iEnd]) < End; ++iEnd)
+        End = std::max(End, Start(fCandidates[iEnd]) + 2);
+      if (End > OpenStart) break;
+      fComponentEnd.push_back(iEnd);
+      iCand = iEnd;
+    }
+    std::size_t const NCompleteCandidates = fComponentEnd.empty() ? 0 : fComponentEnd.back();
+
+    if (NCompleteCandidates > 0) {
+
+      // Counting sort of the hits we have by bin (see `FillAccumulator()`)
+      for (unsigned int iAccum = 0; iAccum != fAccumulators.size(); ++iAccum) {
+        Accumulator const& Accum = fAccumulators[iAccum];
+        auto& Sorted = fScratch.Accumulators[iAccum];
+        Sorted.ContributorStart.assign(Accum.Binned.size() + 1, 0);
+        // hits kept for the other accumulator may lie in bins already dropped
+        for (auto const& Bins : fHitBins)
+          if (Bins[iAccum] >= Accum.Base) ++Sorted.ContributorStart[Bins[iAccum] - Accum.Base + 1];
+        std::partial_sum(Sorted.ContributorStart.begin(),
+                         Sorted.ContributorStart.end(),
+                         Sorted.ContributorStart.begin());
+        Sorted.Contributors.resize(Sorted.ContributorStart.back());
+        for (std::size_t HitIndex = 0; HitIndex != fHits.size(); ++HitIndex) {
+          unsigned int const Bin = fHitBins[HitIndex][iAccum];
+          if (Bin < Accum.Base) continue;
+          Sorted.Contributors[Sorted.ContributorStart[Bin - Accum.Base]++] = HitIndex;
+        }
+        std::copy_backward(Sorted.ContributorStart.begin(),
+                           std::prev(Sorted.ContributorStart.end()),
+                           Sorted.ContributorStart.end());
+        Sorted.ContributorStart[0] = 0;
+      }
+
+      fScratch.HitClaimedByFlash.assign(fHits.size(), -1);
+      fScratch.HitsUsed.assign(fHits.size(), false);
+
+      auto ComponentBegin = fCandidates.begin();
+      for (std::size_t const iEnd : fComponentEnd) {
+        auto const ComponentEnd = fCandidates.begin() + iEnd;
+
+        // Same order as in `AssignHitsToFlash()`: by size, then by
+        // accumulator, then in the order the flash condition was met
+        std::sort(ComponentBegin, ComponentEnd, [](Candidate const& a, Candidate const& b) {
+          return a.Accumulator < b.Accumulator ||
+                 (a.Accumulator == b.Accumulator && a.Order < b.Order);
+        });
+        auto& FlashesBySize = fScratch.FlashesBySize;
+        FlashesBySize.clear();
+        for (auto itCand = ComponentBegin; itCand != ComponentEnd; ++itCand) {
+          Accumulator const& Accum = fAccumulators[itCand->Accumulator];
+          int const Bin = itCand->Bin - Accum.Base;
+          FlashesBySize.push_back({Accum.Binned[Bin], itCand->Accumulator, Bin});
+        }
+        std::stable_sort(FlashesBySize.begin(),
+                         FlashesBySize.end(),
+                         [](FlashFinderScratch::FlashCandidate const& a,
+                            FlashFinderScratch::FlashCandidate const& b) { return a.PE > b.PE; });
+
+        // Claim the hits, as in `AssignHitsToFlash()`
+        auto& FlashHitStart = fScratch.FlashHitStart;
+        auto& FlashHits = fScratch.FlashHits;
+        FlashHitStart.assign(1, 0);
+        FlashHits.clear();
+        for (auto const& Flash : FlashesBySize) {
+          auto const& Sorted = fScratch.Accumulators[Flash.Accumulator];
+          std::size_t const FirstHit = FlashHits.size();
+          double PE = 0;
+          for (std::size_t iHit = Sorted.ContributorStart[Flash.Bin];
+               iHit != Sorted.ContributorStart[Flash.Bin + 1];
+               ++iHit) {
+            int const HitIndex = Sorted.Contributors[iHit];
+            if (fScratch.HitClaimedByFlash[HitIndex] != -1) continue;
+            FlashHits.push_back(HitIndex);
+            PE += fHits[HitIndex].PE();
+          }
+
+          if (PE < fFlashThreshold) {
+            FlashHits.resize(FirstHit);
+            continue;
+          }
+
+          int const FlashIndex = FlashHitStart.size() - 1;
+          FlashHitStart.push_back(FlashHits.size());
+          for (std::size_t iHit = FirstHit; iHit != FlashHits.size(); ++iHit)
+            fScratch.HitClaimedByFlash[FlashHits[iHit]] = FlashIndex;
+        }
+
+        // Refine the flashes of this group
+        for (std::size_t iFlash = 0; iFlash + 1 < FlashHitStart.size(); ++iFlash)
+          RefineHitsInFlash(FlashHits.data() + FlashHitStart[iFlash],
+                            FlashHits.data() + FlashHitStart[iFlash + 1],
+                            fHits,
+                            fRefinedHitsPerFlash,
+                            fWidthTolerance,
+                            fFlashThreshold,
+                            fScratch);
+
+        ComponentBegin = ComponentEnd;
+      } // for complete groups
+
+      fCandidates.erase(fCandidates.begin(), fCandidates.begin() + NCompleteCandidates);
+    }
+
+    // Everything before this position is done with
+    return fCandidates.empty() ? OpenStart : std::min(OpenStart, Start(fCandidates.front()));
+  }
+
+  //----------------------------------------------------------------------------
+  void StreamingFlashFinder::ReleaseFlashes(bool const final,
+                                            std::int64_t const DoneEnd,
+                                            std::vector<recob::OpFlash>& FlashVector,
+                                            std::vector<std::vector<int>>& AssocList)
+  {
+    // Return the flashes which no future flash can precede (with some margin),
+    // removing late light as in `MarkFlashesForRemoval()`
+    std::stable_sort(
+      fPending.begin(), fPending.end(), [](PendingFlash const& a, PendingFlash const& b) {
+        return a.Flash.Time() < b.Flash.Time();
+      });
+    double const DoneTime =
+      final ? std::numeric_limits<double>::infinity() :
+              fMinTime + (DoneEnd - 1) * fBinWidth / 2.0;
+    std::size_t NDone = 0;
+    for (; NDone != fPending.size() && fPending[NDone].Flash.Time() < DoneTime; ++NDone) {
+      PendingFlash& Pending = fPending[NDone];
+      PastFlash const jFlash{
+        Pending.Flash.Time(), Pending.Flash.TotalPE(), Pending.Flash.TimeWidth()};
+
+      bool LateLight = false;
+      for (auto itFlash = fHistory.crbegin(); itFlash != fHistory.crend(); ++itFlash) {
+        if (jFlash.Time - itFlash->Time > fLateLightHorizon) break;
+        if (GetLikelihoodLateLight(
+              itFlash->PE, itFlash->Time, itFlash->Width, jFlash.PE, jFlash.Time, jFlash.Width) <
+            3.0) {
+          LateLight = true;
+          break;
+        }
+      }
+      fHistory.push_back(jFlash);
+
+      if (LateLight) continue;
+      FlashVector.push_back(std::move(Pending.Flash));
+      AssocList.push_back(std::move(Pending.Hits));
+    }
+    fPending.erase(fPending.begin(), fPending.begin() + NDone);
+
+    // Forget the flashes beyond the horizon of any future one
+    if (!fHistory.empty()) {
+      double const HorizonStart = fHistory.back().Time - fLateLightHorizon;
+      auto itKeep = fHistory.begin();
+      while (itKeep != fHistory.end() && itKeep->Time < HorizonStart)
+        ++itKeep;
+      fHistory.erase(fHistory.begin(), itKeep);
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  void StreamingFlashFinder::DropCompleted(std::int64_t const DoneEnd)
+  {
+    // Forget the hits and bins which can't contribute to any flash any more
+    std::size_t NKept = 0;
+    for (std::size_t HitIndex = 0; HitIndex != fHits.size(); ++HitIndex) {
+      auto const& Bins = fHitBins[HitIndex];
+      if (2 * static_cast<std::int64_t>(Bins[0]) + 2 <= DoneEnd &&
+          2 * static_cast<std::int64_t>(Bins[1]) + 1 <= DoneEnd)
+        continue;
+      if (NKept != HitIndex) {
+        fHits[NKept] = std::move(fHits[HitIndex]);
+        fHitIndices[NKept] = fHitIndices[HitIndex];
+        fHitBins[NKept] = Bins;
+      }
+      ++NKept;
+    }
+    fHits.resize(NKept);
+    fHitIndices.resize(NKept);
+    fHitBins.resize(NKept);
+
+    for (unsigned int iAccum = 0; iAccum != fAccumulators.size(); ++iAccum) {
+      Accumulator& Accum = fAccumulators[iAccum];
+      // first bin ending after DoneEnd
+      std::int64_t const FirstBin = std::max<std::int64_t>(0, (DoneEnd + iAccum) / 2);
+      if (FirstBin <= Accum.Base) continue;
+      std::size_t const NDrop = std::min<std::size_t>(FirstBin - Accum.Base, Accum.Binned.size());
+      Accum.Binned.erase(Accum.Binned.begin(), Accum.Binned.begin() + NDrop);
+      Accum.Base += NDrop;
+    }
+  }
+
   //----------------------------------------------------------------------------
   template <typename T, typename Compare>
   std::vector<int> sort_permutation(std::vector<T> const& vec, int offset, Compare compare)
@@ -677,12 +1277,14 @@ namespace opdet {
 
   //----------------------------------------------------------------------------
   template <typename T>
-  void apply_permutation(std::vector<T>& vec, std::vector<int> const& p)
+  void apply_permutation(std::vector<T>& vec, std::vector<int> const& p, int offset)
   {
 
-    std::vector<T> sorted_vec(p.size());
-    std::transform(p.begin(), p.end(), sorted_vec.begin(), [&](int i) { return vec[i]; });
-    vec = sorted_vec;
+    std::vector<T> sorted_vec;
+    sorted_vec.reserve(p.size());
+    for (int i : p)
+      sorted_vec.push_back(std::move(vec[i + offset]));
+    std::move(sorted_vec.begin(), sorted_vec.end(), vec.begin() + offset);
   }
 
 } // End namespace opdet
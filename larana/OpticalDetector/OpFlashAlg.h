@@ -18,12 +18,76 @@ namespace geo {
   class GeometryCore;
 }
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <limits>
 #include <map>
 #include <vector>
 
 namespace opdet {
 
+  /**
+   * @brief Working storage of `RunFlashFinder()`, reusable across events.
+   *
+   * The hits contributing to each accumulator bin are stored in compressed
+   * (CSR) form: the hits of bin `b` are the elements of `Contributors` from
+   * `ContributorStart[b]` to `ContributorStart[b + 1]`, in hit order.
+   * The hits claimed by each flash candidate are stored the same way.
+   * Keeping one instance alive across events lets the storage be reused
+   * instead of reallocated for every event.
+   */
+  struct FlashFinderScratch {
+
+    /// Content of one of the two (staggered) accumulators.
+    struct Accumulator {
+      std::vector<unsigned int> HitBin;          ///< Accumulator bin of each hit.
+      std::vector<double> Binned;                ///< Photoelectrons in each bin.
+      std::vector<std::size_t> ContributorStart; ///< Start of each bin in `Contributors`.
+      std::vector<int> Contributors;             ///< Hits of each bin, bin after bin.
+      std::vector<int> FlashesInAccumulator;     ///< Bins over threshold, in crossing order.
+    };
+
+    /// A bin over threshold, candidate seed of a flash.
+    struct FlashCandidate {
+      double PE;
+      unsigned int Accumulator;
+      int Bin;
+    };
+
+    std::array<Accumulator, 2> Accumulators;
+    std::vector<FlashCandidate> FlashesBySize; ///< Candidates, from the largest.
+    std::vector<int> HitClaimedByFlash;
+    std::vector<std::size_t> FlashHitStart; ///< Start of each flash in `FlashHits`.
+    std::vector<int> FlashHits;             ///< Hits claimed by each flash.
+    std::vector<int> HitsBySize;            ///< Hits of a flash, from the largest.
+    std::vector<bool> HitsUsed;
+    std::vector<int> HitsThisRefinedFlash;
+  };
+
+  /**
+   * @brief Geometry information of each optical channel used to build flashes.
+   *
+   * The information depends only on the channel and the geometry, and it is
+   * precomputed by `MakeOpChannelGeometryTable()`, so that constructing a
+   * flash requires no geometry query. Channel `c` is described by the elements
+   * `c` of each vector, and its nearest wire on plane `p` is
+   * `NearestWire[c * Nplanes + p]`. Channels which are not `Valid` are left
+   * to the geometry service.
+   */
+  struct OpChannelGeometryTable {
+    unsigned int Nplanes = 0;
+    std::vector<bool> Valid;               ///< Whether the channel is known.
+    std::vector<bool> InTPC;               ///< Whether the detector is in a TPC.
+    std::vector<double> CenterY;           ///< Optical detector centre, _y_.
+    std::vector<double> CenterZ;           ///< Optical detector centre, _z_.
+    std::vector<unsigned int> NearestWire; ///< Wire closest to the detector centre.
+  };
+
+  /// Returns the geometry information of all the optical channels in `geom`.
+  OpChannelGeometryTable MakeOpChannelGeometryTable(geo::GeometryCore const& geom);
+
   void RunFlashFinder(std::vector<recob::OpHit> const&,
                       std::vector<recob::OpFlash>&,
                       std::vector<std::vector<int>>&,
@@ -34,6 +98,168 @@ namespace opdet {
                       detinfo::DetectorClocksData const&,
                       float);
 
+  /// Version of `RunFlashFinder()` using (and reusing) the storage in `scratch`,
+  /// the channel geometry in `ChannelGeometry` if not null, and looking for
+  /// late light only within `LateLightHorizon` (see `RemoveLateLight()`).
+  void RunFlashFinder(std::vector<recob::OpHit> const&,
+                      std::vector<recob::OpFlash>&,
+                      std::vector<std::vector<int>>&,
+                      double,
+                      geo::GeometryCore const&,
+                      float,
+                      float,
+                      detinfo::DetectorClocksData const&,
+                      float,
+                      FlashFinderScratch& scratch,
+                      OpChannelGeometryTable const* ChannelGeometry = nullptr,
+                      double LateLightHorizon = std::numeric_limits<double>::infinity());
+
+  /**
+   * @brief Flash finder processing the hits in time-ordered chunks.
+   *
+   * Hits are passed to `AddHits()` in chunks, and no hit of a chunk may be
+   * earlier than any hit of the previous chunks (hits within a chunk need not
+   * be sorted). Flashes are returned as soon as no later hit can affect them,
+   * and between chunks only the accumulator bins and hits which may still
+   * contribute to a flash are kept. `Finish()` returns the remaining flashes
+   * at the end of the input.
+   *
+   * The result is the same as the one of `RunFlashFinder()` on all the hits
+   * at once, in chunk order and with the same late light horizon, except for
+   * the relative order of flashes with the same time. The hit indices in the
+   * associations refer to that concatenated hit list.
+   * With a finite late light horizon the memory used does not depend on the
+   * length of the input.
+   *
+   * The flashes are built by `ConstructFlash()`, or by a `FlashMaker_t`
+   * function: nothing else depends on the geometry.
+   */
+  class StreamingFlashFinder {
+  public:
+    /// Appends to the flash list the flash made of the hits with the given
+    /// indices in the hit list (same as the first arguments of `ConstructFlash()`).
+    using FlashMaker_t = std::function<void(std::vector<int> const& HitsPerFlashVec,
+                                            std::vector<recob::OpHit> const& HitVector,
+                                            std::vector<recob::OpFlash>& FlashVector)>;
+
+    StreamingFlashFinder(double BinWidth,
+                         float FlashThreshold,
+                         float WidthTolerance,
+                         float TrigCoinc,
+                         double LateLightHorizon);
+
+    /// Adds a chunk of hits, and appends the flashes completed so far.
+    void AddHits(std::vector<recob::OpHit> const& HitVector,
+                 std::vector<recob::OpFlash>& FlashVector,
+                 std::vector<std::vector<int>>& AssocList,
+                 geo::GeometryCore const& geom,
+                 detinfo::DetectorClocksData const& ClocksData,
+                 OpChannelGeometryTable const* ChannelGeometry = nullptr);
+
+    /// Version of `AddHits()` building the flashes with `MakeFlash`.
+    void AddHits(std::vector<recob::OpHit> const& HitVector,
+                 std::vector<recob::OpFlash>& FlashVector,
+                 std::vector<std::vector<int>>& AssocList,
+                 FlashMaker_t const& MakeFlash);
+
+    /// Appends all the remaining flashes, and gets ready for a new input.
+    void Finish(std::vector<recob::OpFlash>& FlashVector,
+                std::vector<std::vector<int>>& AssocList,
+                geo::GeometryCore const& geom,
+                detinfo::DetectorClocksData const& ClocksData,
+                OpChannelGeometryTable const* ChannelGeometry = nullptr);
+
+    /// Version of `Finish()` building the flashes with `MakeFlash`.
+    void Finish(std::vector<recob::OpFlash>& FlashVector,
+                std::vector<std::vector<int>>& AssocList,
+                FlashMaker_t const& MakeFlash);
+
+    /// Discards all the hits and flashes not returned yet.
+    void Reset();
+
+  private:
+    /// Accumulator bins still in use, starting from bin number `Base`.
+    struct Accumulator {
+      unsigned int Base = 0;
+      std::vector<double> Binned;
+    };
+
+    /// A bin which met the flash condition (`Order` is the crossing order).
+    struct Candidate {
+      unsigned int Accumulator;
+      unsigned int Bin;
+      unsigned long Order;
+    };
+
+    /// A flash not returned yet, with the (global) indices of its hits.
+    struct PendingFlash {
+      recob::OpFlash Flash;
+      std::vector<int> Hits;
+    };
+
+    /// What is needed of a returned flash to check the late light of others.
+    struct PastFlash {
+      double Time;
+      double PE;
+      double Width;
+    };
+
+    double fBinWidth;
+    float fFlashThreshold;
+    float fWidthTolerance;
+    float fTrigCoinc;
+    double fLateLightHorizon;
+
+    bool fStarted = false;
+    double fMinTime = 0.;   ///< Time of the accumulator bin 0.
+    double fWatermark = 0.; ///< No future hit may be earlier than this.
+    int fNextHitIndex = 0;
+    unsigned long fNCrossings = 0;
+
+    std::array<Accumulator, 2> fAccumulators;
+    std::vector<Candidate> fCandidates; ///< Bins over threshold not processed yet.
+
+    std::vector<recob::OpHit> fHits;                  ///< Hits still needed.
+    std::vector<int> fHitIndices;                     ///< Global index of each hit.
+    std::vector<std::array<unsigned int, 2>> fHitBins; ///< Bins of each hit.
+
+    std::vector<PendingFlash> fPending; ///< Flashes not returned yet.
+    std::vector<PastFlash> fHistory;    ///< Returned flashes within the horizon.
+
+    FlashFinderScratch fScratch;
+    std::vector<std::size_t> fComponentEnd;
+    std::vector<std::vector<int>> fRefinedHitsPerFlash;
+    std::vector<recob::OpFlash> fNewFlashes;
+
+    /// Returns a `FlashMaker_t` calling `ConstructFlash()`.
+    FlashMaker_t GeometryFlashMaker(geo::GeometryCore const& geom,
+                                    detinfo::DetectorClocksData const& ClocksData,
+                                    OpChannelGeometryTable const* ChannelGeometry) const;
+
+    /// Processes the bins which can't change any more, then returns the flashes
+    /// which can't change any more (everything if `final`).
+    void Process(bool final,
+                 std::vector<recob::OpFlash>& FlashVector,
+                 std::vector<std::vector<int>>& AssocList,
+                 FlashMaker_t const& MakeFlash);
+
+    /// Groups the flash bins which can't change any more (all of them if
+    /// `final`), claims their hits and refines them into `fRefinedHitsPerFlash`
+    /// (indices in `fHits`), as `AssignHitsToFlash()` and `RefineHitsInFlash()`
+    /// do. Returns the position (in half bins) before which no bin will change.
+    std::int64_t RefineCompleteFlashes(bool final);
+
+    /// Returns the pending flashes before `DoneEnd` (all if `final`), except
+    /// the late light of earlier ones, as in `MarkFlashesForRemoval()`.
+    void ReleaseFlashes(bool final,
+                        std::int64_t DoneEnd,
+                        std::vector<recob::OpFlash>& FlashVector,
+                        std::vector<std::vector<int>>& AssocList);
+
+    /// Forgets the hits and bins which can't contribute to any flash from `DoneEnd` on.
+    void DropCompleted(std::int64_t DoneEnd);
+  };
+
   unsigned int GetAccumIndex(double PeakTime, double MinTime, double BinWidth, double BinOffset);
 
   void FillAccumulator(unsigned int const& AccumIndex,
@@ -44,6 +270,14 @@ namespace opdet {
                        std::vector<std::vector<int>>& Contributors,
                        std::vector<int>& FlashesInAccumulator);
 
+  /// Fills a whole accumulator with `HitVector`, with contributors in CSR form.
+  void FillAccumulator(std::vector<recob::OpHit> const& HitVector,
+                       double MinTime,
+                       double BinWidth,
+                       double BinOffset,
+                       float FlashThreshold,
+                       FlashFinderScratch::Accumulator& Accum);
+
   void AssignHitsToFlash(std::vector<int> const&,
                          std::vector<int> const&,
                          std::vector<double> const&,
@@ -54,6 +288,12 @@ namespace opdet {
                          std::vector<std::vector<int>>&,
                          float);
 
+  /// Assigns hits to flashes using the accumulators in `scratch`; the
+  /// result is stored in `scratch.FlashHitStart` and `scratch.FlashHits`.
+  void AssignHitsToFlash(std::vector<recob::OpHit> const& HitVector,
+                         float FlashThreshold,
+                         FlashFinderScratch& scratch);
+
   void FillFlashesBySizeMap(
     std::vector<int> const& FlashesInAccumulator,
     std::vector<double> const& BinnedPE,
@@ -77,6 +317,16 @@ namespace opdet {
                          float WidthTolerance,
                          float FlashThreshold);
 
+  /// Version of `RefineHitsInFlash()` on the hits in [`HitsBegin`, `HitsEnd`);
+  /// `scratch.HitsUsed` must be sized for `HitVector` and be all `false`.
+  void RefineHitsInFlash(int const* HitsBegin,
+                         int const* HitsEnd,
+                         std::vector<recob::OpHit> const& HitVector,
+                         std::vector<std::vector<int>>& RefinedHitsPerFlash,
+                         float WidthTolerance,
+                         float FlashThreshold,
+                         FlashFinderScratch& scratch);
+
   void FindSeedHit(std::map<double, std::vector<int>, std::greater<double>> const& HitsBySize,
                    std::vector<bool>& HitsUsed,
                    std::vector<recob::OpHit> const& HitVector,
@@ -105,7 +355,8 @@ namespace opdet {
                       std::vector<recob::OpFlash>& FlashVector,
                       geo::GeometryCore const& geom,
                       detinfo::DetectorClocksData const& data,
-                      float TrigCoinc);
+                      float TrigCoinc,
+                      OpChannelGeometryTable const* ChannelGeometry = nullptr);
 
   void AddHitContribution(recob::OpHit const& currentHit,
                           double& MaxTime,
@@ -125,7 +376,27 @@ namespace opdet {
                           double& sumz,
                           double& sumz2);
 
-  void RemoveLateLight(std::vector<recob::OpFlash>&, std::vector<std::vector<int>>&);
+  /// Version of `GetHitGeometryInfo()` looking up the precomputed geometry.
+  void GetHitGeometryInfo(recob::OpHit const& currentHit,
+                          OpChannelGeometryTable const& ChannelGeometry,
+                          geo::GeometryCore const& geom,
+                          std::vector<double>& sumw,
+                          std::vector<double>& sumw2,
+                          double& sumy,
+                          double& sumy2,
+                          double& sumz,
+                          double& sumz2);
+
+  /**
+   * @brief Removes the flashes compatible with the late light of earlier ones.
+   *
+   * Only flashes at most `LateLightHorizon` (microseconds) after a flash are
+   * checked against it: the expected late light decays exponentially, and a
+   * finite horizon makes the cost linear in the number of flashes.
+   */
+  void RemoveLateLight(std::vector<recob::OpFlash>&,
+                       std::vector<std::vector<int>>&,
+                       double LateLightHorizon = std::numeric_limits<double>::infinity());
 
   double GetLikelihoodLateLight(double iPE,
                                 double iTime,
@@ -134,9 +405,13 @@ namespace opdet {
                                 double jTime,
                                 double jWidth);
 
-  void MarkFlashesForRemoval(std::vector<recob::OpFlash> const& FlashVector,
-                             size_t BeginFlash,
-                             std::vector<bool>& MarkedForRemoval);
+  /// Flashes from `BeginFlash` on must be sorted by time when a finite
+  /// `LateLightHorizon` is used.
+  void MarkFlashesForRemoval(
+    std::vector<recob::OpFlash> const& FlashVector,
+    size_t BeginFlash,
+    std::vector<bool>& MarkedForRemoval,
+    double LateLightHorizon = std::numeric_limits<double>::infinity());
 
   void RemoveFlashesFromVectors(std::vector<bool> const& MarkedForRemoval,
                                 std::vector<recob::OpFlash>& FlashVector,
@@ -147,7 +422,7 @@ namespace opdet {
   std::vector<int> sort_permutation(std::vector<T> const& vec, int offset, Compare compare);
 
   template <typename T>
-  void apply_permutation(std::vector<T>& vec, std::vector<int> const& p);
+  void apply_permutation(std::vector<T>& vec, std::vector<int> const& p, int offset = 0);
 
 } // End opdet namespace
 
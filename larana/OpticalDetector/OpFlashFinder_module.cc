@@ -30,6 +30,7 @@
 // ROOT includes
 
 // C++ Includes
+#include <limits>
 #include <memory>
 #include <string>
 
@@ -51,6 +52,10 @@ namespace opdet {
     Float_t fFlashThreshold;
     Float_t fWidthTolerance;
     Double_t fTrigCoinc;
+    double fLateLightHorizon;
+
+    OpChannelGeometryTable fChannelGeometry; // geometry information of each channel
+    FlashFinderScratch fScratch;             // flash finder storage, reused across events
   };
 
 }
@@ -73,6 +78,10 @@ namespace opdet {
     fFlashThreshold = pset.get<float>("FlashThreshold");
     fWidthTolerance = pset.get<float>("WidthTolerance");
     fTrigCoinc = pset.get<double>("TrigCoinc");
+    fLateLightHorizon =
+      pset.get<double>("LateLightHorizon", std::numeric_limits<double>::infinity());
+
+    fChannelGeometry = MakeOpChannelGeometryTable(*lar::providerFrom<geo::Geometry>());
 
     produces<std::vector<recob::OpFlash>>();
     produces<art::Assns<recob::OpFlash, recob::OpHit>>();
@@ -105,7 +114,10 @@ namespace opdet {
                    fFlashThreshold,
                    fWidthTolerance,
                    clock_data,
-                   fTrigCoinc);
+                   fTrigCoinc,
+                   fScratch,
+                   &fChannelGeometry,
+                   fLateLightHorizon);
 
     // Make the associations which we noted we need
     for (size_t i = 0; i != assocList.size(); ++i) {
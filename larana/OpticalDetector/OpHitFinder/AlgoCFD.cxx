@@ -9,7 +9,7 @@
 
 #include "fhiclcpp/ParameterSet.h"
 
-#include <unordered_map>
+#include <algorithm>
 
 namespace pmtana {
 
@@ -48,15 +48,16 @@ namespace pmtana {
   }
 
   //***************************************************************
-  bool AlgoCFD::RecoPulse(const pmtana::Waveform_t& wf,
-                          const pmtana::PedestalMean_t& mean_v,
-                          const pmtana::PedestalSigma_t& sigma_v)
+  bool AlgoCFD::RecoPulse(pmtana::WaveformView_t wf,
+                          pmtana::PedestalMeanView_t mean_v,
+                          pmtana::PedestalSigmaView_t sigma_v)
   //***************************************************************
   {
 
     Reset();
 
-    std::vector<double> cfd;
+    auto& cfd = _cfd;
+    cfd.clear();
     cfd.reserve(wf.size());
 
     // follow cfd procedure: invert waveform, multiply by constant fraction
@@ -77,7 +78,7 @@ namespace pmtana {
     // Get the zero point crossings, how can I tell which are meaningful?
     // go to each crossing, see if waveform is above pedestal (high above pedestal)
 
-    auto crossings = LinearZeroPointX(cfd);
+    LinearZeroPointX(cfd, _crossings);
 
     // lambda criteria to determine if inside pulse
 
@@ -85,169 +86,102 @@ namespace pmtana {
       return wf.at(i) > sigma_v.at(i) * thresh + mean_v.at(i);
     };
 
-    // loop over CFD crossings
-    for (const auto& cross : crossings) {
-
-      if (in_peak(cross.first, _peak_thresh)) {
-        _pulse.reset_param();
-
-        int i = cross.first;
-
-        //backwards
-        while (in_peak(i, _start_thresh)) {
-          i--;
-          if (i < 0) {
-            i = 0;
-            break;
-          }
-        }
-        _pulse.t_start = i;
-
-        //walk a little further backwards to see if we can get 5 low RMS
-        // while ( !in_peak(i,_start_thresh) ) {
-        //   if (i == ( _pulse.t_start - _number_presample ) ) break;
-        //   i--;
-        //   if ( i < 0 ) { i = 0; break; }
-        // }
-
-        // auto before_mean = double{0.0};
-
-        // if ( _pulse.t_start - i > 0 )
-        //   before_mean = std::accumulate(std::begin(mean_v) + i,
-        // 				std::begin(mean_v) + _pulse.t_start, 0.0) / ((double) (_pulse.t_start - i));
-
-        i = _pulse.t_start + 1;
-
-        //forwards
-        while (in_peak(i, _end_thresh)) {
-          i++;
-          if (i > (int)(wf.size()) - 1) {
-            i = (int)(wf.size()) - 1;
-            break;
-          }
-        }
-
-        _pulse.t_end = i;
-
-        // //walk a little further forwards to see if we can get 5 low RMS
-        // while ( !in_peak(i,_end_thresh) ) {
-        //   if (i == ( _pulse.t_end + _number_presample ) ) break;
-        //   i++;
-        //   if ( i > wf.size() - 1 ) { i = wf.size() - 1; break; }
-        // }
-
-        // auto after_mean = double{0.0};
-
-        // if( i - _pulse.t_end > 0)
-        //   after_mean = std::accumulate(std::begin(mean_v) + _pulse.t_end + 1,
-        // 			       std::begin(mean_v) + i + 1, 0.0) / ((double) (i - _pulse.t_end));
-
-        //how to decide before or after? set before for now
-        //if ( wf.size() < 1500 ) //it's cosmic discriminator
-        //before_mean = mean_v.front();
-
-        // if( after_mean <= 0 and before_mean <= 0 ) {
-        //   std::cerr << "\033[93m<<" << __FUNCTION__ << ">>\033[00m Could not find good pedestal for CDF"
-        // 	    << " both before_mean and after_mean are zero or less? Ignoring this crossing." << std::endl;
-        //   continue;
-        // }
-
-        //x
-
-        auto start_ped = mean_v.at(_pulse.t_start);
-        auto end_ped = mean_v.at(_pulse.t_end);
-
-        //just take the "smaller one"
-        _pulse.ped_mean = start_ped <= end_ped ? start_ped : end_ped;
-
-        if (wf.size() < 50) _pulse.ped_mean = mean_v.front(); //is COSMIC DISCRIMINATOR
-
-        auto it = std::max_element(std::begin(wf) + _pulse.t_start, std::begin(wf) + _pulse.t_end);
-
-        _pulse.t_max = it - std::begin(wf);
-        _pulse.peak = *it - _pulse.ped_mean;
-        _pulse.t_cfdcross = cross.second;
-
-        for (auto k = _pulse.t_start; k <= _pulse.t_end; ++k) {
-          auto a = wf.at(k) - _pulse.ped_mean;
-          if (a > 0) _pulse.area += a;
-        }
-
-        if (_risetime_calc_ptr)
-          _pulse.t_rise = _risetime_calc_ptr->RiseTime(
-            {wf.begin() + _pulse.t_start, wf.begin() + _pulse.t_end},
-            {mean_v.begin() + _pulse.t_start, mean_v.begin() + _pulse.t_end},
-            true);
-
-        _pulse_v.push_back(_pulse);
-      }
-    }
-
     // Vic:
     // Very close in time pulses have multiple CFD
     // crossing points. Should we check that pulses now have
     // some multiplicity? No lets just delete them.
+    //
+    // The start of a pulse is the last sample before the crossing below the
+    // start threshold, and its end is found walking forward from its start:
+    // crossings in the same region above the start threshold give the same
+    // pulse, and only the first one is kept. Pulses sharing the same end are
+    // also duplicates, and the widest (the first one) is kept.
+    // Crossings are in time order, so both walks can resume from where the
+    // previous crossing left them, and each sample is tested at most once
+    // for each threshold.
+    int const last_index = (int)(wf.size()) - 1;
+    int start_scan = 0; // samples before this were tested for the start threshold
+    int last_low = -1;  // last of them below the start threshold
+    int prev_start = -1, prev_end = -1;
 
-    auto pulses_copy = _pulse_v;
-    _pulse_v.clear();
-
-    std::unordered_map<unsigned, pulse_param> delta;
+    // loop over CFD crossings
+    for (const auto& cross : _crossings) {
 
-    //unsigned width = 0;
-    for (const auto& p : pulses_copy) {
+      if (!in_peak(cross.first, _peak_thresh)) {
+        CountRejectedPulse();
+        continue;
+      }
 
-      if (delta.count(p.t_start)) {
-        if ((p.t_end - p.t_start) > (delta[p.t_start].t_end - delta[p.t_start].t_start))
-          delta[p.t_start] = p;
-        else
-          continue;
+      //backwards (done forward, from where the previous crossing stopped)
+      for (; start_scan <= (int)cross.first; ++start_scan) {
+        if (!in_peak(start_scan, _start_thresh)) last_low = start_scan;
       }
-      else {
-        delta[p.t_start] = p;
+      int const t_start = last_low < 0 ? 0 : last_low;
+
+      // same start, same pulse
+      if (t_start == prev_start) continue;
+      prev_start = t_start;
+
+      // the walk forward would end where the previous one did: duplicate end
+      if (t_start < prev_end) continue;
+
+      //forwards
+      int i = t_start + 1;
+      while (in_peak(i, _end_thresh)) {
+        i++;
+        if (i > last_index) {
+          i = last_index;
+          break;
+        }
       }
-    }
+      prev_end = i;
 
-    for (const auto& p : delta)
-      _pulse_v.push_back(p.second);
+      _pulse.reset_param();
+      _pulse.t_start = t_start;
+      _pulse.t_end = i;
 
-    //do the same now ensure t_final's are all unique
-    //width = 0;
+      auto start_ped = mean_v.at(_pulse.t_start);
+      auto end_ped = mean_v.at(_pulse.t_end);
 
-    pulses_copy.clear();
-    pulses_copy = _pulse_v;
+      //just take the "smaller one"
+      _pulse.ped_mean = start_ped <= end_ped ? start_ped : end_ped;
 
-    _pulse_v.clear();
-    delta.clear();
+      if (wf.size() < 50) _pulse.ped_mean = mean_v.front(); //is COSMIC DISCRIMINATOR
 
-    for (const auto& p : pulses_copy) {
+      auto it = std::max_element(wf.begin() + (size_t)_pulse.t_start,
+                                 wf.begin() + (size_t)_pulse.t_end);
 
-      if (delta.count(p.t_end)) {
-        if ((p.t_end - p.t_start) > (delta[p.t_end].t_end - delta[p.t_end].t_start))
-          delta[p.t_end] = p;
-        else
-          continue;
-      }
-      else {
-        delta[p.t_end] = p;
+      _pulse.t_max = it - std::begin(wf);
+      _pulse.peak = *it - _pulse.ped_mean;
+      _pulse.t_cfdcross = cross.second;
+
+      for (auto k = _pulse.t_start; k <= _pulse.t_end; ++k) {
+        auto a = wf.at(k) - _pulse.ped_mean;
+        if (a > 0) _pulse.area += a;
       }
-    }
 
-    for (const auto& p : delta)
-      _pulse_v.push_back(p.second);
+      if (_risetime_calc_ptr)
+        _pulse.t_rise = RiseTime(wf.subspan(_pulse.t_start, _pulse.t_end - _pulse.t_start),
+                                 mean_v.subspan(_pulse.t_start, _pulse.t_end - _pulse.t_start),
+                                 true);
+
+      _pulse_v.push_back(_pulse);
+    }
 
-    //there should be no overlapping pulses now...
+    //there should be no overlapping pulses now, and they are sorted in time...
 
     return true;
   }
 
   // currently returns ALL zero point crossings, we really just want ones associated with peak...
-  const std::map<unsigned, double> AlgoCFD::LinearZeroPointX(const std::vector<double>& trace)
+  void AlgoCFD::LinearZeroPointX(const std::vector<double>& trace,
+                                 std::vector<std::pair<unsigned, double>>& crossing) const
   {
 
-    std::map<unsigned, double> crossing;
+    crossing.clear();
 
     //step through the trace and find where slope is POSITIVE across zero
-    for (unsigned i = 0; i < trace.size() - 1; ++i) {
+    for (unsigned i = 0; i + 1 < trace.size(); ++i) {
 
       auto si = ::pmtana::sign(trace.at(i));
       auto sf = ::pmtana::sign(trace.at(i + 1));
@@ -260,10 +194,9 @@ namespace pmtana {
 
       //calculate the crossing X based on linear interpolation bt two pts
 
-      crossing[i] = (double)i - trace.at(i) * (1.0 / (trace.at(i + 1) - trace.at(i)));
+      crossing.emplace_back(i,
+                            (double)i - trace.at(i) * (1.0 / (trace.at(i + 1) - trace.at(i))));
     }
-
-    return crossing;
   }
 
 }
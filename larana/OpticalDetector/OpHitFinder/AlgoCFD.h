@@ -23,8 +23,8 @@ namespace fhicl {
 
 #include "larana/OpticalDetector/OpHitFinder/OpticalRecoTypes.h"
 
-#include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace pmtana {
@@ -50,11 +50,13 @@ namespace pmtana {
 
   protected:
     /// Implementation of AlgoCFD::reco() method
-    bool RecoPulse(const pmtana::Waveform_t&,
-                   const pmtana::PedestalMean_t&,
-                   const pmtana::PedestalSigma_t&);
+    bool RecoPulse(pmtana::WaveformView_t,
+                   pmtana::PedestalMeanView_t,
+                   pmtana::PedestalSigmaView_t);
 
-    const std::map<unsigned, double> LinearZeroPointX(const std::vector<double>& trace);
+    /// Fills `crossing` with the (index, interpolated time) of the upward zero crossings, in order.
+    void LinearZeroPointX(const std::vector<double>& trace,
+                          std::vector<std::pair<unsigned, double>>& crossing) const;
 
   private:
     float _F;
@@ -64,6 +66,10 @@ namespace pmtana {
     double _peak_thresh;
     double _start_thresh;
     double _end_thresh;
+
+    /// Buffers reused across waveforms.
+    std::vector<double> _cfd;
+    std::vector<std::pair<unsigned, double>> _crossings;
   };
 
 }
@@ -49,9 +49,24 @@ namespace pmtana {
   }
 
   //***************************************************************
-  bool AlgoFixedWindow::RecoPulse(const Waveform_t& wf,
-                                  const PedestalMean_t& mean_v,
-                                  const PedestalSigma_t& sigma_v)
+  bool AlgoFixedWindow::RecoPulse(WaveformView_t wf,
+                                  PedestalMeanView_t mean_v,
+                                  PedestalSigmaView_t sigma_v)
+  //***************************************************************
+  {
+    return RecoPulseImpl(wf, PedestalArrays(mean_v, sigma_v));
+  }
+
+  //***************************************************************
+  bool AlgoFixedWindow::RecoPulseModel(WaveformView_t wf, const PedestalModel& ped)
+  //***************************************************************
+  {
+    return RecoPulseImpl(wf, ped);
+  }
+
+  //***************************************************************
+  template <typename Pedestal>
+  bool AlgoFixedWindow::RecoPulseImpl(WaveformView_t wf, const Pedestal& ped)
   //***************************************************************
   {
     this->Reset();
@@ -60,9 +75,9 @@ namespace pmtana {
 
     _pulse_v[0].t_start = (double)(_index_start);
 
-    _pulse_v[0].ped_mean = mean_v.front();
+    _pulse_v[0].ped_mean = ped.Mean(0);
 
-    _pulse_v[0].ped_sigma = sigma_v.front();
+    _pulse_v[0].ped_sigma = ped.Sigma(0);
 
     if (!_index_end)
 
@@ -79,17 +94,17 @@ namespace pmtana {
     _pulse_v[0].t_max =
       PMTPulseRecoBase::Max(wf, _pulse_v[0].peak, _index_start, _pulse_v[0].t_end);
 
-    _pulse_v[0].peak -= mean_v.front();
+    _pulse_v[0].peak -= ped.Mean(0);
 
     PMTPulseRecoBase::Integral(wf, _pulse_v[0].area, _index_start, _pulse_v[0].t_end);
 
     _pulse_v[0].area =
-      _pulse_v[0].area - (_pulse_v[0].t_end - _pulse_v[0].t_start + 1) * mean_v.front();
+      _pulse_v[0].area - (_pulse_v[0].t_end - _pulse_v[0].t_start + 1) * ped.Mean(0);
 
     if (_risetime_calc_ptr)
-      _pulse_v[0].t_rise = _risetime_calc_ptr->RiseTime(
-        {wf.begin() + _pulse.t_start, wf.begin() + _pulse.t_end},
-        {mean_v.begin() + _pulse.t_start, mean_v.begin() + _pulse.t_end},
+      _pulse_v[0].t_rise = RiseTime(
+        wf.subspan(_pulse_v[0].t_start, _pulse_v[0].t_end - _pulse_v[0].t_start),
+        ped.MeanView(_pulse_v[0].t_start, _pulse_v[0].t_end - _pulse_v[0].t_start),
         true);
 
     return true;
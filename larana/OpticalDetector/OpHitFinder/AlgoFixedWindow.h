@@ -52,12 +52,20 @@ namespace pmtana {
 
   protected:
     /// Implementation of AlgoFixedWindow::reco() method
-    bool RecoPulse(const pmtana::Waveform_t&,
-                   const pmtana::PedestalMean_t&,
-                   const pmtana::PedestalSigma_t&);
+    bool RecoPulse(pmtana::WaveformView_t,
+                   pmtana::PedestalMeanView_t,
+                   pmtana::PedestalSigmaView_t);
+
+    /// Implementation with a compact pedestal: only its value at the first sample is needed
+    bool RecoPulseModel(pmtana::WaveformView_t, const pmtana::PedestalModel&);
 
     size_t _index_start; ///< index marker for the beginning of the pulse time window
     size_t _index_end;   ///< index marker for the end of pulse time window
+
+  private:
+    /// Common implementation for dense (PedestalArrays) and compact (PedestalModel) pedestals
+    template <typename Pedestal>
+    bool RecoPulseImpl(pmtana::WaveformView_t wf, const Pedestal& ped);
   };
 
 }
@@ -31,9 +31,22 @@ namespace pmtana {
   void AlgoSiPM::Reset() { PMTPulseRecoBase::Reset(); }
 
   //---------------------------------------------------------------------------
-  bool AlgoSiPM::RecoPulse(const pmtana::Waveform_t& wf,
-                           const pmtana::PedestalMean_t& ped_mean,
-                           const pmtana::PedestalSigma_t& ped_rms)
+  bool AlgoSiPM::RecoPulse(pmtana::WaveformView_t wf,
+                           pmtana::PedestalMeanView_t ped_mean,
+                           pmtana::PedestalSigmaView_t ped_rms)
+  {
+    return RecoPulseImpl(wf, PedestalArrays(ped_mean, ped_rms));
+  }
+
+  //---------------------------------------------------------------------------
+  bool AlgoSiPM::RecoPulseModel(pmtana::WaveformView_t wf, const pmtana::PedestalModel& ped)
+  {
+    return RecoPulseImpl(wf, ped);
+  }
+
+  //---------------------------------------------------------------------------
+  template <typename Pedestal>
+  bool AlgoSiPM::RecoPulseImpl(pmtana::WaveformView_t wf, const Pedestal& ped)
   {
 
     bool fire = false;
@@ -43,8 +56,7 @@ namespace pmtana {
     //                                                    : (_nsigma*_ped_rms));
     //double pedestal      = _pedestal;
     double pedestal =
-      ped_mean
-        .front(); //Switch pedestal definition to incoroprate pedestal finder - K.S. 04/18/2019
+      ped.Mean(0); //Switch pedestal definition to incoroprate pedestal finder - K.S. 04/18/2019
 
     double threshold = _adc_thres;
     threshold += pedestal;
@@ -70,14 +82,15 @@ namespace pmtana {
         _pulse.t_end = counter - 1;
         if (record_hit && ((_pulse.t_end - _pulse.t_start) >= _min_width)) {
           if (_risetime_calc_ptr)
-            _pulse.t_rise = _risetime_calc_ptr->RiseTime(
-              {wf.begin() + _pulse.t_start, wf.begin() + _pulse.t_end},
-              {ped_mean.begin() + _pulse.t_start, ped_mean.begin() + _pulse.t_end},
-              true);
+            _pulse.t_rise = RiseTime(wf.subspan(_pulse.t_start, _pulse.t_end - _pulse.t_start),
+                                     ped.MeanView(_pulse.t_start, _pulse.t_end - _pulse.t_start),
+                                     true);
 
           _pulse_v.push_back(_pulse);
           record_hit = false;
         }
+        else
+          CountRejectedPulse();
         _pulse.reset_param();
       }
 
@@ -107,14 +120,15 @@ namespace pmtana {
       _pulse.t_end = counter - 1;
       if (record_hit && ((_pulse.t_end - _pulse.t_start) >= _min_width)) {
         if (_risetime_calc_ptr)
-          _pulse.t_rise = _risetime_calc_ptr->RiseTime(
-            {wf.begin() + _pulse.t_start, wf.begin() + _pulse.t_end},
-            {ped_mean.begin() + _pulse.t_start, ped_mean.begin() + _pulse.t_end},
-            true);
+          _pulse.t_rise = RiseTime(wf.subspan(_pulse.t_start, _pulse.t_end - _pulse.t_start),
+                                   ped.MeanView(_pulse.t_start, _pulse.t_end - _pulse.t_start),
+                                   true);
 
         _pulse_v.push_back(_pulse);
         record_hit = false;
       }
+      else
+        CountRejectedPulse();
       _pulse.reset_param();
     }
 
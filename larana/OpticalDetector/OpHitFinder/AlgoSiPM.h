@@ -31,6 +31,9 @@ namespace pmtana {
     // Implementation of PMTPulseRecoBase::Reset() method
     void Reset();
 
+    /// No pulse without a sample above the absolute threshold to record a hit
+    double MinPulseExcursion() const { return _adc_thres; }
+
     // A method to set user-defined ADC threshold value
     //      void SetADCThreshold(double v) {_adc_thres = v;};
 
@@ -39,9 +42,12 @@ namespace pmtana {
     //      void SetNSigma(double v) {_nsigma = v;};
 
   protected:
-    bool RecoPulse(const pmtana::Waveform_t&,
-                   const pmtana::PedestalMean_t&,
-                   const pmtana::PedestalSigma_t&);
+    bool RecoPulse(pmtana::WaveformView_t,
+                   pmtana::PedestalMeanView_t,
+                   pmtana::PedestalSigmaView_t);
+
+    /// Implementation with a compact pedestal: only its value at the first sample is needed
+    bool RecoPulseModel(pmtana::WaveformView_t, const pmtana::PedestalModel&);
 
     // A variable holder for a user-defined absolute ADC threshold value
     double _adc_thres;
@@ -58,6 +64,11 @@ namespace pmtana {
     // A variable holder for a multiplicative factor for the pedestal
     // standard deviation to define the threshold
     //      double _nsigma;
+
+  private:
+    /// Common implementation for dense (PedestalArrays) and compact (PedestalModel) pedestals
+    template <typename Pedestal>
+    bool RecoPulseImpl(pmtana::WaveformView_t wf, const Pedestal& ped);
   };
 
 }
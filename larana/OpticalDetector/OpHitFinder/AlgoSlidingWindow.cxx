@@ -8,6 +8,8 @@
 
 #include "AlgoSlidingWindow.h"
 
+#include <algorithm>
+
 namespace pmtana {
 
   //*********************************************************************
@@ -46,6 +48,8 @@ namespace pmtana {
 
     _min_width = pset.get<size_t>("MinPulseWidth", 0);
 
+    _reco_pulse = SelectRecoPulse(_positive, _verbose);
+
     _risetime_calc_ptr = std::move(risetimecalculator);
 
     Reset();
@@ -59,9 +63,59 @@ namespace pmtana {
   }
 
   //***************************************************************
-  bool AlgoSlidingWindow::RecoPulse(const pmtana::Waveform_t& wf,
-                                    const pmtana::PedestalMean_t& mean_v,
-                                    const pmtana::PedestalSigma_t& sigma_v)
+  AlgoSlidingWindow::RecoPulseImpl_t AlgoSlidingWindow::SelectRecoPulse(bool positive, bool verbose)
+  //***************************************************************
+  {
+    if (positive)
+      return verbose ? &AlgoSlidingWindow::RecoPulseImpl<true, true> :
+                       &AlgoSlidingWindow::RecoPulseImpl<true, false>;
+    else
+      return verbose ? &AlgoSlidingWindow::RecoPulseImpl<false, true> :
+                       &AlgoSlidingWindow::RecoPulseImpl<false, false>;
+  }
+
+  //***************************************************************
+  template <bool Positive>
+  void AlgoSlidingWindow::FlagStartCandidates(pmtana::WaveformView_t wf,
+                                              pmtana::PedestalMeanView_t mean_v,
+                                              pmtana::PedestalSigmaView_t sigma_v)
+  //***************************************************************
+  {
+    // Branch-free loop the compiler can vectorize; the thresholds are
+    // evaluated exactly as in the pulse state machine of RecoPulseImpl().
+    size_t const n = wf.size();
+    _start_candidate_v.resize(n);
+
+    short const* adc = wf.data();
+    double const* mean = mean_v.data();
+    double const* sigma = sigma_v.data();
+    char* flag = _start_candidate_v.data();
+
+    double const adc_thres = _adc_thres;
+    double const nsigma = _nsigma;
+
+    for (size_t i = 0; i < n; ++i) {
+      double const value = Positive ? ((double)(adc[i])) - mean[i] : mean[i] - ((double)(adc[i]));
+      double const sigma_thres = sigma[i] * nsigma;
+      double const start_threshold = sigma_thres < adc_thres ? adc_thres : (float)sigma_thres;
+      flag[i] = value > start_threshold;
+    }
+  }
+
+  //***************************************************************
+  bool AlgoSlidingWindow::RecoPulse(pmtana::WaveformView_t wf,
+                                    pmtana::PedestalMeanView_t mean_v,
+                                    pmtana::PedestalSigmaView_t sigma_v)
+  //***************************************************************
+  {
+    return (this->*_reco_pulse)(wf, mean_v, sigma_v);
+  }
+
+  //***************************************************************
+  template <bool Positive, bool Verbose>
+  bool AlgoSlidingWindow::RecoPulseImpl(pmtana::WaveformView_t wf,
+                                        pmtana::PedestalMeanView_t mean_v,
+                                        pmtana::PedestalSigmaView_t sigma_v)
   //***************************************************************
   {
 
@@ -87,13 +141,18 @@ namespace pmtana {
 
     Reset();
 
+    FlagStartCandidates<Positive>(wf, mean_v, sigma_v);
+
     for (size_t i = 0; i < wf.size(); ++i) {
 
-      double value = 0.;
-      if (_positive)
-        value = ((double)(wf[i])) - mean_v[i];
-      else
-        value = mean_v[i] - ((double)(wf[i]));
+      // Out of a pulse only a sample above the start threshold matters: skip to the next one
+      if (!fire && !in_tail && !in_post) {
+        i = std::find(_start_candidate_v.begin() + i, _start_candidate_v.end(), 1) -
+            _start_candidate_v.begin();
+        if (i == wf.size()) break;
+      }
+
+      double const value = Positive ? ((double)(wf[i])) - mean_v[i] : mean_v[i] - ((double)(wf[i]));
 
       float start_threshold = 0.;
       float tail_threshold = 0.;
@@ -117,17 +176,19 @@ namespace pmtana {
           // Register if width is acceptable
           if ((_pulse.t_end - _pulse.t_start) >= _min_width) {
             if (_risetime_calc_ptr)
-              _pulse.t_rise = _risetime_calc_ptr->RiseTime(
-                {wf.begin() + _pulse.t_start, wf.begin() + _pulse.t_end},
-                {mean_v.begin() + _pulse.t_start, mean_v.begin() + _pulse.t_end},
-                _positive);
+              _pulse.t_rise = RiseTime(
+                wf.subspan(_pulse.t_start, _pulse.t_end - _pulse.t_start),
+                mean_v.subspan(_pulse.t_start, _pulse.t_end - _pulse.t_start),
+                Positive);
 
             _pulse_v.push_back(_pulse);
           }
+          else
+            CountRejectedPulse();
 
           _pulse.reset_param();
 
-          if (_verbose)
+          if constexpr (Verbose)
             std::cout << "\033[93mPulse End\033[00m: "
                       << "baseline: " << mean_v[i] << " ... "
                       << " ... adc above: " << value << " T=" << i << std::endl;
@@ -169,17 +230,19 @@ namespace pmtana {
           // Register if width is acceptable
           if ((_pulse.t_end - _pulse.t_start) >= _min_width) {
             if (_risetime_calc_ptr)
-              _pulse.t_rise = _risetime_calc_ptr->RiseTime(
-                {wf.begin() + _pulse.t_start, wf.begin() + _pulse.t_end},
-                {mean_v.begin() + _pulse.t_start, mean_v.begin() + _pulse.t_end},
-                _positive);
+              _pulse.t_rise = RiseTime(
+                wf.subspan(_pulse.t_start, _pulse.t_end - _pulse.t_start),
+                mean_v.subspan(_pulse.t_start, _pulse.t_end - _pulse.t_start),
+                Positive);
 
             _pulse_v.push_back(_pulse);
           }
+          else
+            CountRejectedPulse();
 
           _pulse.reset_param();
 
-          if (_verbose)
+          if constexpr (Verbose)
             std::cout << "\033[93mPulse End\033[00m: new pulse starts during in_post: "
                       << "baseline: " << mean_v[i] << " ... "
                       << " ... adc above: " << value << " T=" << i << std::endl;
@@ -191,16 +254,13 @@ namespace pmtana {
 
         for (size_t pre_index = _pulse.t_start; pre_index < i; ++pre_index) {
 
-          double pre_adc = wf[pre_index];
-          if (_positive)
-            pre_adc -= pulse_start_baseline;
-          else
-            pre_adc = pulse_start_baseline - pre_adc;
+          double const pre_adc = Positive ? wf[pre_index] - pulse_start_baseline :
+                                            pulse_start_baseline - wf[pre_index];
 
           if (pre_adc > 0.) _pulse.area += pre_adc;
         }
 
-        if (_verbose)
+        if constexpr (Verbose)
           std::cout << "\033[93mPulse Start\033[00m: "
                     << "baseline: " << mean_v[i] << " ... threshold: " << start_threshold
                     << " ... adc above baseline: " << value << " ... pre-adc sum: " << _pulse.area
@@ -217,10 +277,12 @@ namespace pmtana {
         in_post = false;
       }
 
-      if ((fire || in_tail || in_post) && _verbose) {
-        std::cout << (fire ? "\033[93mPulsing\033[00m: " : "\033[93mIn-tail\033[00m: ")
-                  << "baseline: " << mean_v[i] << " std: " << sigma_v[i]
-                  << " ... adc above baseline " << value << " T=" << i << std::endl;
+      if constexpr (Verbose) {
+        if (fire || in_tail || in_post) {
+          std::cout << (fire ? "\033[93mPulsing\033[00m: " : "\033[93mIn-tail\033[00m: ")
+                    << "baseline: " << mean_v[i] << " std: " << sigma_v[i]
+                    << " ... adc above baseline " << value << " T=" << i << std::endl;
+        }
       }
 
       if ((fire || in_tail) && value < pulse_end_threshold) {
@@ -236,15 +298,16 @@ namespace pmtana {
         // Register if width is acceptable
         if ((_pulse.t_end - _pulse.t_start) >= _min_width) {
           if (_risetime_calc_ptr)
-            _pulse.t_rise = _risetime_calc_ptr->RiseTime(
-              {wf.begin() + _pulse.t_start, wf.begin() + _pulse.t_end},
-              {mean_v.begin() + _pulse.t_start, mean_v.begin() + _pulse.t_end},
-              _positive);
+            _pulse.t_rise = RiseTime(wf.subspan(_pulse.t_start, _pulse.t_end - _pulse.t_start),
+                                     mean_v.subspan(_pulse.t_start, _pulse.t_end - _pulse.t_start),
+                                     Positive);
 
           _pulse_v.push_back(_pulse);
         }
+        else
+          CountRejectedPulse();
 
-        if (_verbose)
+        if constexpr (Verbose)
           std::cout << "\033[93mPulse End\033[00m: "
                     << "baseline: " << mean_v[i] << " ... adc: " << value << " T=" << i
                     << " ... area sum " << _pulse.area << std::endl;
@@ -285,12 +348,13 @@ namespace pmtana {
       // Register if width is acceptable
       if ((_pulse.t_end - _pulse.t_start) >= _min_width) {
         if (_risetime_calc_ptr)
-          _pulse.t_rise = _risetime_calc_ptr->RiseTime(
-            {wf.begin() + _pulse.t_start, wf.begin() + _pulse.t_end},
-            {mean_v.begin() + _pulse.t_start, mean_v.begin() + _pulse.t_end},
-            _positive);
+          _pulse.t_rise = RiseTime(wf.subspan(_pulse.t_start, _pulse.t_end - _pulse.t_start),
+                                   mean_v.subspan(_pulse.t_start, _pulse.t_end - _pulse.t_start),
+                                   Positive);
         _pulse_v.push_back(_pulse);
       }
+      else
+        CountRejectedPulse();
 
       _pulse.reset_param();
     }
@@ -23,6 +23,7 @@ namespace fhicl {
 #include "larana/OpticalDetector/OpHitFinder/OpticalRecoTypes.h"
 
 #include <string>
+#include <vector>
 
 namespace pmtana {
 
@@ -45,11 +46,14 @@ namespace pmtana {
     /// Implementation of AlgoSlidingWindow::reset() method
     void Reset();
 
+    /// No pulse without a sample above the absolute start threshold
+    double MinPulseExcursion() const { return _adc_thres; }
+
   protected:
     /// Implementation of AlgoSlidingWindow::reco() method
-    bool RecoPulse(const pmtana::Waveform_t&,
-                   const pmtana::PedestalMean_t&,
-                   const pmtana::PedestalSigma_t&);
+    bool RecoPulse(pmtana::WaveformView_t,
+                   pmtana::PedestalMeanView_t,
+                   pmtana::PedestalSigmaView_t);
 
     /// A boolean to set waveform positive/negative polarity
     bool _positive;
@@ -64,6 +68,33 @@ namespace pmtana {
     float _nsigma, _tail_nsigma, _end_nsigma;
     bool _verbose;
     size_t _num_presample, _num_postsample;
+
+  private:
+    /// Signature of the RecoPulse() implementations
+    typedef bool (AlgoSlidingWindow::*RecoPulseImpl_t)(pmtana::WaveformView_t,
+                                                        pmtana::PedestalMeanView_t,
+                                                        pmtana::PedestalSigmaView_t);
+
+    /// Returns the RecoPulse() implementation for the given polarity and verbosity
+    static RecoPulseImpl_t SelectRecoPulse(bool positive, bool verbose);
+
+    /// RecoPulse() implementation with polarity and verbosity fixed at compile time
+    template <bool Positive, bool Verbose>
+    bool RecoPulseImpl(pmtana::WaveformView_t,
+                       pmtana::PedestalMeanView_t,
+                       pmtana::PedestalSigmaView_t);
+
+    /// Flags in `_start_candidate_v` the samples which are above the start threshold
+    template <bool Positive>
+    void FlagStartCandidates(pmtana::WaveformView_t,
+                             pmtana::PedestalMeanView_t,
+                             pmtana::PedestalSigmaView_t);
+
+    /// Implementation used by RecoPulse(), chosen at configuration
+    RecoPulseImpl_t _reco_pulse = &AlgoSlidingWindow::RecoPulseImpl<true, false>;
+
+    /// Per-sample flag: the sample is above the start threshold (reused buffer)
+    std::vector<char> _start_candidate_v;
   };
 
 }
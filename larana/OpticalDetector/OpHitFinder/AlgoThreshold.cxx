@@ -49,17 +49,32 @@ namespace pmtana {
   }
 
   //***************************************************************
-  bool AlgoThreshold::RecoPulse(const Waveform_t& wf,
-                                const PedestalMean_t& mean_v,
-                                const PedestalSigma_t& sigma_v)
+  bool AlgoThreshold::RecoPulse(WaveformView_t wf,
+                                PedestalMeanView_t mean_v,
+                                PedestalSigmaView_t sigma_v)
+  //***************************************************************
+  {
+    return RecoPulseImpl(wf, PedestalArrays(mean_v, sigma_v));
+  }
+
+  //***************************************************************
+  bool AlgoThreshold::RecoPulseModel(WaveformView_t wf, const PedestalModel& ped)
+  //***************************************************************
+  {
+    return RecoPulseImpl(wf, ped);
+  }
+
+  //***************************************************************
+  template <typename Pedestal>
+  bool AlgoThreshold::RecoPulseImpl(WaveformView_t wf, const Pedestal& ped)
   //***************************************************************
   {
     bool fire = false;
 
     double counter = 0;
 
-    double ped_mean = mean_v.front();
-    double ped_rms = sigma_v.front();
+    double ped_mean = ped.Mean(0);
+    double ped_rms = ped.Sigma(0);
 
     //double threshold = ( _adc_thres > (_nsigma * ped_rms) ? _adc_thres : (_nsigma * ped_rms) );
     auto start_threshold =
@@ -101,10 +116,9 @@ namespace pmtana {
         _pulse.t_end = counter < wf.size() ? counter : counter - 1;
 
         if (_risetime_calc_ptr)
-          _pulse.t_rise = _risetime_calc_ptr->RiseTime(
-            {wf.begin() + _pulse.t_start, wf.begin() + _pulse.t_end},
-            {mean_v.begin() + _pulse.t_start, mean_v.begin() + _pulse.t_end},
-            true);
+          _pulse.t_rise = RiseTime(wf.subspan(_pulse.t_start, _pulse.t_end - _pulse.t_start),
+                                   ped.MeanView(_pulse.t_start, _pulse.t_end - _pulse.t_start),
+                                   true);
 
         _pulse_v.push_back(_pulse);
 
@@ -141,10 +155,9 @@ namespace pmtana {
       _pulse.t_end = counter - 1;
 
       if (_risetime_calc_ptr)
-        _pulse.t_rise = _risetime_calc_ptr->RiseTime(
-          {wf.begin() + _pulse.t_start, wf.begin() + _pulse.t_end},
-          {mean_v.begin() + _pulse.t_start, mean_v.begin() + _pulse.t_end},
-          true);
+        _pulse.t_rise = RiseTime(wf.subspan(_pulse.t_start, _pulse.t_end - _pulse.t_start),
+                                 ped.MeanView(_pulse.t_start, _pulse.t_end - _pulse.t_start),
+                                 true);
 
       _pulse_v.push_back(_pulse);
 
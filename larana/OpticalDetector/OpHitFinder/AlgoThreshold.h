@@ -48,11 +48,17 @@ namespace pmtana {
     /// Implementation of AlgoThreshold::reset() method
     void Reset();
 
+    /// No pulse without a sample above the absolute start threshold
+    double MinPulseExcursion() const { return _start_adc_thres; }
+
   protected:
     /// Implementation of AlgoThreshold::reco() method
-    bool RecoPulse(const pmtana::Waveform_t& wf,
-                   const pmtana::PedestalMean_t& mean_v,
-                   const pmtana::PedestalSigma_t& sigma_v);
+    bool RecoPulse(pmtana::WaveformView_t wf,
+                   pmtana::PedestalMeanView_t mean_v,
+                   pmtana::PedestalSigmaView_t sigma_v);
+
+    /// Implementation with a compact pedestal: only its value at the first sample is needed
+    bool RecoPulseModel(pmtana::WaveformView_t, const pmtana::PedestalModel&);
 
     /// A variable holder for a user-defined absolute ADC threshold value
     //double _adc_thres;
@@ -63,6 +69,11 @@ namespace pmtana {
     //double _nsigma;
     double _nsigma_start;
     double _nsigma_end;
+
+  private:
+    /// Common implementation for dense (PedestalArrays) and compact (PedestalModel) pedestals
+    template <typename Pedestal>
+    bool RecoPulseImpl(pmtana::WaveformView_t wf, const Pedestal& ped);
   };
 
 }
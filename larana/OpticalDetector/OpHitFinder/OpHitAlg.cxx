@@ -22,9 +22,143 @@
 #include "larreco/Calibrator/IPhotonCalibrator.h"
 #include "messagefacility/MessageLogger/MessageLogger.h"
 
+#include "tbb/blocked_range.h"
+#include "tbb/parallel_for.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
 #include <vector>
 
+namespace {
+
+  // access a waveform from either a waveform collection or a pointer collection
+  raw::OpDetWaveform const& deref(raw::OpDetWaveform const& waveform)
+  {
+    return waveform;
+  }
+
+  raw::OpDetWaveform const& deref(raw::OpDetWaveform const* waveform)
+  {
+    return *waveform;
+  }
+
+  /// Reconstructs the pulses of the waveforms from `begin` to `end` and appends them to `pulses`.
+  template <typename Waveforms>
+  void ReconstructPulseRange(Waveforms const& waveforms,
+                             std::size_t begin,
+                             std::size_t end,
+                             pmtana::PulseTable& pulses,
+                             pmtana::PulseRecoManager const& pulseRecoMgr,
+                             pmtana::PMTPulseRecoBase const& threshAlg,
+                             geo::GeometryCore const& geometry)
+  {
+
+    for (std::size_t iWaveform = begin; iWaveform != end; ++iWaveform) {
+
+      raw::OpDetWaveform const& waveform = deref(waveforms[iWaveform]);
+
+      const int channel = static_cast<int>(waveform.ChannelNumber());
+
+      if (!geometry.IsValidOpChannel(channel)) {
+        mf::LogError("OpHitFinder") << "Error! unrecognized channel number " << channel
+                                    << ". Ignoring pulse";
+        continue;
+      }
+
+      pulseRecoMgr.Reconstruct(waveform, channel);
+
+      pulses.append(channel, waveform.TimeStamp(), threshAlg.GetPulses());
+    }
+  }
+
+  /// Runs the hit finding on a collection of waveforms or of waveform pointers.
+  template <typename Waveforms>
+  void RunHitFinderSerial(Waveforms const& waveforms,
+                          std::vector<recob::OpHit>& hitVector,
+                          pmtana::PulseRecoManager const& pulseRecoMgr,
+                          pmtana::PMTPulseRecoBase const& threshAlg,
+                          geo::GeometryCore const& geometry,
+                          float hitThreshold,
+                          detinfo::DetectorClocksData const& clocksData,
+                          calib::IPhotonCalibrator const& calibrator,
+                          bool use_start_time)
+  {
+
+    pmtana::PulseTable pulses;
+    pulses.reserve(waveforms.size());
+
+    ReconstructPulseRange(
+      waveforms, 0, waveforms.size(), pulses, pulseRecoMgr, threshAlg, geometry);
+
+    opdet::ConstructHits(pulses, hitVector, hitThreshold, clocksData, calibrator, use_start_time);
+  }
+
+  /// Multi-threaded version of `RunHitFinderSerial()`.
+  template <typename Waveforms>
+  void RunHitFinderParallel(Waveforms const& waveforms,
+                            std::vector<recob::OpHit>& hitVector,
+                            opdet::HitFinderWorkers_t& workers,
+                            geo::GeometryCore const& geometry,
+                            float hitThreshold,
+                            detinfo::DetectorClocksData const& clocksData,
+                            calib::IPhotonCalibrator const& calibrator,
+                            bool use_start_time)
+  {
+
+    // waveforms are processed in batches, each one through a pulse table;
+    // hits are collected per batch, and merged in input order afterwards
+    constexpr std::size_t BatchSize = 64;
+    std::size_t const nBatches = (waveforms.size() + BatchSize - 1) / BatchSize;
+    std::vector<std::vector<recob::OpHit>> batchHits(nBatches);
+
+    tbb::parallel_for(
+      tbb::blocked_range<std::size_t>(0, nBatches),
+      [&](tbb::blocked_range<std::size_t> const& range) {
+        opdet::HitFinderWorker& worker = *workers.local();
+        for (std::size_t iBatch = range.begin(); iBatch != range.end(); ++iBatch) {
+          std::size_t const begin = iBatch * BatchSize;
+          std::size_t const end = std::min(begin + BatchSize, waveforms.size());
+          worker.pulses.clear();
+          ReconstructPulseRange(waveforms,
+                                begin,
+                                end,
+                                worker.pulses,
+                                worker.pulseRecoMgr,
+                                *worker.threshAlg,
+                                geometry);
+          opdet::ConstructHits(worker.pulses,
+                               batchHits[iBatch],
+                               hitThreshold,
+                               clocksData,
+                               calibrator,
+                               use_start_time);
+        }
+      });
+
+    std::size_t nHits = hitVector.size();
+    for (auto const& hits : batchHits)
+      nHits += hits.size();
+    hitVector.reserve(nHits);
+
+    for (auto& hits : batchHits)
+      hitVector.insert(hitVector.end(),
+                       std::make_move_iterator(hits.begin()),
+                       std::make_move_iterator(hits.end()));
+  }
+
+}
+
 namespace opdet {
+  //----------------------------------------------------------------------------
+  HitFinderWorker::HitFinderWorker(std::unique_ptr<pmtana::PMTPulseRecoBase> threshAlg,
+                                   std::unique_ptr<pmtana::PMTPedestalBase> pedAlg)
+    : threshAlg{std::move(threshAlg)}, pedAlg{std::move(pedAlg)}
+  {
+    pulseRecoMgr.AddRecoAlgo(this->threshAlg.get());
+    pulseRecoMgr.SetDefaultPedAlgo(this->pedAlg.get());
+  }
+
   //----------------------------------------------------------------------------
   void RunHitFinder(std::vector<raw::OpDetWaveform> const& opDetWaveformVector,
                     std::vector<recob::OpHit>& hitVector,
@@ -36,33 +170,166 @@ namespace opdet {
                     calib::IPhotonCalibrator const& calibrator,
                     bool use_start_time)
   {
+    RunHitFinderSerial(opDetWaveformVector,
+                       hitVector,
+                       pulseRecoMgr,
+                       threshAlg,
+                       geometry,
+                       hitThreshold,
+                       clocksData,
+                       calibrator,
+                       use_start_time);
+  }
+
+  //----------------------------------------------------------------------------
+  void RunHitFinder(std::vector<raw::OpDetWaveform const*> const& opDetWaveformPtrs,
+                    std::vector<recob::OpHit>& hitVector,
+                    pmtana::PulseRecoManager const& pulseRecoMgr,
+                    pmtana::PMTPulseRecoBase const& threshAlg,
+                    geo::GeometryCore const& geometry,
+                    float hitThreshold,
+                    detinfo::DetectorClocksData const& clocksData,
+                    calib::IPhotonCalibrator const& calibrator,
+                    bool use_start_time)
+  {
+    RunHitFinderSerial(opDetWaveformPtrs,
+                       hitVector,
+                       pulseRecoMgr,
+                       threshAlg,
+                       geometry,
+                       hitThreshold,
+                       clocksData,
+                       calibrator,
+                       use_start_time);
+  }
 
-    for (auto const& waveform : opDetWaveformVector) {
+  //----------------------------------------------------------------------------
+  void RunHitFinder(std::vector<raw::OpDetWaveform> const& opDetWaveformVector,
+                    std::vector<recob::OpHit>& hitVector,
+                    HitFinderWorkers_t& workers,
+                    geo::GeometryCore const& geometry,
+                    float hitThreshold,
+                    detinfo::DetectorClocksData const& clocksData,
+                    calib::IPhotonCalibrator const& calibrator,
+                    bool use_start_time)
+  {
+    RunHitFinderParallel(opDetWaveformVector,
+                         hitVector,
+                         workers,
+                         geometry,
+                         hitThreshold,
+                         clocksData,
+                         calibrator,
+                         use_start_time);
+  }
 
-      const int channel = static_cast<int>(waveform.ChannelNumber());
+  //----------------------------------------------------------------------------
+  void RunHitFinder(std::vector<raw::OpDetWaveform const*> const& opDetWaveformPtrs,
+                    std::vector<recob::OpHit>& hitVector,
+                    HitFinderWorkers_t& workers,
+                    geo::GeometryCore const& geometry,
+                    float hitThreshold,
+                    detinfo::DetectorClocksData const& clocksData,
+                    calib::IPhotonCalibrator const& calibrator,
+                    bool use_start_time)
+  {
+    RunHitFinderParallel(opDetWaveformPtrs,
+                         hitVector,
+                         workers,
+                         geometry,
+                         hitThreshold,
+                         clocksData,
+                         calibrator,
+                         use_start_time);
+  }
 
-      if (!geometry.IsValidOpChannel(channel)) {
-        mf::LogError("OpHitFinder")
-          << "Error! unrecognized channel number " << channel << ". Ignoring pulse";
-        continue;
+  //----------------------------------------------------------------------------
+  void ReconstructPulses(std::vector<raw::OpDetWaveform> const& opDetWaveformVector,
+                         pmtana::PulseTable& pulses,
+                         pmtana::PulseRecoManager const& pulseRecoMgr,
+                         pmtana::PMTPulseRecoBase const& threshAlg,
+                         geo::GeometryCore const& geometry)
+  {
+    ReconstructPulseRange(opDetWaveformVector,
+                          0,
+                          opDetWaveformVector.size(),
+                          pulses,
+                          pulseRecoMgr,
+                          threshAlg,
+                          geometry);
+  }
+
+  //----------------------------------------------------------------------------
+  void ReconstructPulses(std::vector<raw::OpDetWaveform const*> const& opDetWaveformPtrs,
+                         pmtana::PulseTable& pulses,
+                         pmtana::PulseRecoManager const& pulseRecoMgr,
+                         pmtana::PMTPulseRecoBase const& threshAlg,
+                         geo::GeometryCore const& geometry)
+  {
+    ReconstructPulseRange(
+      opDetWaveformPtrs, 0, opDetWaveformPtrs.size(), pulses, pulseRecoMgr, threshAlg, geometry);
+  }
+
+  //----------------------------------------------------------------------------
+  void ConstructHits(pmtana::PulseTable const& pulses,
+                     std::vector<recob::OpHit>& hitVector,
+                     float hitThreshold,
+                     detinfo::DetectorClocksData const& clocksData,
+                     calib::IPhotonCalibrator const& calibrator,
+                     bool use_start_time)
+  {
+
+    auto const& opticalClock = clocksData.OpticalClock();
+    double const tickPeriod = opticalClock.TickPeriod();
+    double const triggerTime = clocksData.TriggerTime();
+    bool const useArea = calibrator.UseArea();
+
+    std::vector<double> const& hitTime = use_start_time ? pulses.t_start : pulses.t_max;
+
+    hitVector.reserve(hitVector.size() + pulses.size());
+
+    // pulses of the same waveform are contiguous: the frame is computed once for each
+    bool haveFrame = false;
+    double frameTimeStamp = 0.0;
+    int frame = 0;
+
+    for (std::size_t iPulse = 0; iPulse < pulses.size(); ++iPulse) {
+
+      if (pulses.peak[iPulse] < hitThreshold) continue;
+
+      double const timeStamp = pulses.time_stamp[iPulse];
+      int const channel = pulses.channel[iPulse];
+
+      if (!haveFrame || timeStamp != frameTimeStamp) {
+        frame = opticalClock.Frame(timeStamp);
+        frameTimeStamp = timeStamp;
+        haveFrame = true;
       }
 
-      pulseRecoMgr.Reconstruct(waveform);
+      double absTime = timeStamp + tickPeriod * hitTime[iPulse];
+
+      double relTime = absTime - triggerTime;
+
+      double startTime = timeStamp + tickPeriod * pulses.t_start[iPulse] - triggerTime;
+
+      double riseTime = tickPeriod * pulses.t_rise[iPulse];
 
-      // Get the result
-      auto const& pulses = threshAlg.GetPulses();
+      double PE = useArea ? calibrator.PE(pulses.area[iPulse], channel) :
+                            calibrator.PE(pulses.peak[iPulse], channel);
 
-      const double timeStamp = waveform.TimeStamp();
+      double width = (pulses.t_end[iPulse] - pulses.t_start[iPulse]) * tickPeriod;
 
-      for (auto const& pulse : pulses)
-        ConstructHit(hitThreshold,
-                     channel,
-                     timeStamp,
-                     pulse,
-                     hitVector,
-                     clocksData,
-                     calibrator,
-                     use_start_time);
+      hitVector.emplace_back(channel,
+                             relTime,
+                             absTime,
+                             startTime,
+                             riseTime,
+                             frame,
+                             width,
+                             pulses.area[iPulse],
+                             pulses.peak[iPulse],
+                             PE,
+                             0.0);
     }
   }
 
@@ -10,10 +10,16 @@
  * These are the algorithms used by OpHit to produce optical hits.
  */
 
+#include "larana/OpticalDetector/OpHitFinder/PMTPedestalBase.h"
 #include "larana/OpticalDetector/OpHitFinder/PMTPulseRecoBase.h"
+#include "larana/OpticalDetector/OpHitFinder/PulseRecoManager.h"
+#include "larana/OpticalDetector/OpHitFinder/PulseTable.h"
 #include "lardataobj/RawData/OpDetWaveform.h"
 #include "lardataobj/RecoBase/OpHit.h"
 
+#include "tbb/enumerable_thread_specific.h"
+
+#include <memory>
 #include <vector>
 
 namespace calib {
@@ -25,12 +31,32 @@ namespace detinfo {
 namespace geo {
   class GeometryCore;
 }
-namespace pmtana {
-  class PulseRecoManager;
-}
 
 namespace opdet {
 
+  /**
+   * @brief Pulse reconstruction algorithms owned by a single hit finding thread.
+   *
+   * The pedestal and pulse algorithms keep per-waveform state, so concurrent
+   * hit finding requires each thread to run its own instances. The worker
+   * takes ownership of both algorithms and registers them with its own
+   * `pmtana::PulseRecoManager`. The pulse table is reused by all the
+   * waveform batches of the thread.
+   */
+  struct HitFinderWorker {
+
+    HitFinderWorker(std::unique_ptr<pmtana::PMTPulseRecoBase> threshAlg,
+                    std::unique_ptr<pmtana::PMTPedestalBase> pedAlg);
+
+    std::unique_ptr<pmtana::PMTPulseRecoBase> const threshAlg;
+    std::unique_ptr<pmtana::PMTPedestalBase> const pedAlg;
+    pmtana::PulseRecoManager pulseRecoMgr;
+    pmtana::PulseTable pulses;
+  };
+
+  /// Per-thread hit finder workers, created on first use in each thread.
+  using HitFinderWorkers_t = tbb::enumerable_thread_specific<std::unique_ptr<HitFinderWorker>>;
+
   void RunHitFinder(std::vector<raw::OpDetWaveform> const&,
                     std::vector<recob::OpHit>&,
                     pmtana::PulseRecoManager const&,
@@ -41,6 +67,78 @@ namespace opdet {
                     calib::IPhotonCalibrator const&,
                     bool use_start_time = false);
 
+  /// Version of `RunHitFinder()` working on waveforms owned elsewhere.
+  void RunHitFinder(std::vector<raw::OpDetWaveform const*> const&,
+                    std::vector<recob::OpHit>&,
+                    pmtana::PulseRecoManager const&,
+                    pmtana::PMTPulseRecoBase const&,
+                    geo::GeometryCore const&,
+                    float,
+                    detinfo::DetectorClocksData const&,
+                    calib::IPhotonCalibrator const&,
+                    bool use_start_time = false);
+
+  /**
+   * @brief Multi-threaded version of `RunHitFinder()`.
+   *
+   * Waveforms are distributed among the available threads with work stealing,
+   * and each thread reconstructs them with its own worker from `workers`.
+   * Hits are merged in the order of the input waveforms, so the output is
+   * identical to the one of the single-threaded version.
+   */
+  void RunHitFinder(std::vector<raw::OpDetWaveform> const&,
+                    std::vector<recob::OpHit>&,
+                    HitFinderWorkers_t&,
+                    geo::GeometryCore const&,
+                    float,
+                    detinfo::DetectorClocksData const&,
+                    calib::IPhotonCalibrator const&,
+                    bool use_start_time = false);
+
+  /// Multi-threaded version of `RunHitFinder()` on waveforms owned elsewhere.
+  void RunHitFinder(std::vector<raw::OpDetWaveform const*> const&,
+                    std::vector<recob::OpHit>&,
+                    HitFinderWorkers_t&,
+                    geo::GeometryCore const&,
+                    float,
+                    detinfo::DetectorClocksData const&,
+                    calib::IPhotonCalibrator const&,
+                    bool use_start_time = false);
+
+  /**
+   * @brief Reconstructs the pulses of a waveform collection into a pulse table.
+   *
+   * The pulses found by `threshAlg`, which must be run by `pulseRecoMgr`, are
+   * appended to `pulses` in the order of the waveforms. Waveforms on invalid
+   * channels are skipped.
+   */
+  void ReconstructPulses(std::vector<raw::OpDetWaveform> const&,
+                         pmtana::PulseTable&,
+                         pmtana::PulseRecoManager const&,
+                         pmtana::PMTPulseRecoBase const&,
+                         geo::GeometryCore const&);
+
+  /// Version of `ReconstructPulses()` working on waveforms owned elsewhere.
+  void ReconstructPulses(std::vector<raw::OpDetWaveform const*> const&,
+                         pmtana::PulseTable&,
+                         pmtana::PulseRecoManager const&,
+                         pmtana::PMTPulseRecoBase const&,
+                         geo::GeometryCore const&);
+
+  /**
+   * @brief Converts all the pulses of a table into hits.
+   *
+   * The result is the same as from `ConstructHit()` called on each pulse, but
+   * the clock quantities are evaluated once per table (per waveform for the
+   * frame number).
+   */
+  void ConstructHits(pmtana::PulseTable const&,
+                     std::vector<recob::OpHit>&,
+                     float,
+                     detinfo::DetectorClocksData const&,
+                     calib::IPhotonCalibrator const&,
+                     bool use_start_time = false);
+
   void ConstructHit(float,
                     int,
                     double,
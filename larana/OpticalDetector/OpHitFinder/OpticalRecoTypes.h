@@ -1,6 +1,8 @@
 #ifndef larana_OPTICALDETECTOR_OPTICALRECOTYPES_H
 #define larana_OPTICALDETECTOR_OPTICALRECOTYPES_H
 
+#include <cstddef>
+#include <stdexcept>
 #include <vector>
 
 namespace pmtana {
@@ -9,5 +11,58 @@ namespace pmtana {
   typedef std::vector<double> PedestalMean_t;
   typedef std::vector<double> PedestalSigma_t;
 
+  /**
+   * @brief Non-owning, read-only view of a contiguous array (a minimal `std::span`).
+   *
+   * A view can be created from a `std::vector` or from a pointer and a size,
+   * and it never copies the data: the viewed memory must outlive the view.
+   * This allows algorithms to process sub-ranges and externally owned buffers
+   * without allocations.
+   */
+  template <typename T>
+  class ArrayView {
+
+  public:
+    typedef T value_type;
+    typedef T const* const_iterator;
+
+    ArrayView() = default;
+
+    ArrayView(T const* data, std::size_t size) : _data(data), _size(size) {}
+
+    ArrayView(std::vector<T> const& v) : _data(v.data()), _size(v.size()) {}
+
+    T const* data() const { return _data; }
+    std::size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+
+    const_iterator begin() const { return _data; }
+    const_iterator end() const { return _data + _size; }
+
+    T const& operator[](std::size_t i) const { return _data[i]; }
+    T const& front() const { return _data[0]; }
+    T const& back() const { return _data[_size - 1]; }
+
+    T const& at(std::size_t i) const
+    {
+      if (i >= _size) throw std::out_of_range("pmtana::ArrayView::at(): index out of range");
+      return _data[i];
+    }
+
+    /// Returns a view of `count` elements starting at `offset`.
+    ArrayView subspan(std::size_t offset, std::size_t count) const
+    {
+      return {_data + offset, count};
+    }
+
+  private:
+    T const* _data = nullptr;
+    std::size_t _size = 0;
+  };
+
+  typedef ArrayView<short> WaveformView_t;
+  typedef ArrayView<double> PedestalMeanView_t;
+  typedef ArrayView<double> PedestalSigmaView_t;
+
 }
 #endif
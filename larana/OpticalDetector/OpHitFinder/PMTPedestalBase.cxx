@@ -10,9 +10,11 @@
 namespace pmtana {
 
   //**************************************************************
-  PMTPedestalBase::PMTPedestalBase(std::string name) : _name(name), _mean_v(), _sigma_v()
+  PMTPedestalBase::PMTPedestalBase(std::string name) : _name(name), _model()
   //**************************************************************
-  {}
+  {
+    ResetStats();
+  }
 
   //*********************************
   PMTPedestalBase::~PMTPedestalBase()
@@ -27,60 +29,91 @@ namespace pmtana {
   }
 
   //************************************************************
-  bool PMTPedestalBase::Evaluate(const ::pmtana::Waveform_t& wf)
+  bool PMTPedestalBase::Evaluate(pmtana::WaveformView_t wf)
   //************************************************************
   {
-    _mean_v.resize(wf.size(), 0);
-    _sigma_v.resize(wf.size(), 0);
+    StatsClock_t::time_point start;
+    if (_collect_stats) start = StatsClock_t::now();
 
-    for (size_t i = 0; i < wf.size(); ++i)
-      _mean_v[i] = _sigma_v[i] = 0;
+    const bool res = ComputePedestalModel(wf, _model);
 
-    const bool res = ComputePedestal(wf, _mean_v, _sigma_v);
+    if (_collect_stats) {
+      _stats.time += SecondsSince(start);
+      ++_stats.n_waveforms;
+      _stats.n_samples += wf.size();
+    }
 
-    if (wf.size() != _mean_v.size())
-      throw OpticalRecoException("Internal error: computed pedestal mean array length changed!");
-    if (wf.size() != _sigma_v.size())
-      throw OpticalRecoException("Internal error: computed pedestal sigma array length changed!");
+    if (_model.IsDense()) {
+      if (wf.size() != _model.DenseMean().size())
+        throw OpticalRecoException("Internal error: computed pedestal mean array length changed!");
+      if (wf.size() != _model.DenseSigma().size())
+        throw OpticalRecoException("Internal error: computed pedestal sigma array length changed!");
+    }
+    if (wf.size() != _model.size())
+      throw OpticalRecoException("Internal error: computed pedestal length changed!");
 
     return res;
   }
 
+  //***************************************************************************************
+  bool PMTPedestalBase::ComputePedestalModel(pmtana::WaveformView_t wf, PedestalModel& model)
+  //***************************************************************************************
+  {
+    model.SetDense(wf.size());
+    return ComputePedestal(wf, model.DenseMean(), model.DenseSigma());
+  }
+
   //*******************************************
   double PMTPedestalBase::Mean(size_t i) const
   //*******************************************
   {
-    if (i > _mean_v.size()) {
+    if (i >= _model.size()) {
       std::stringstream ss;
       ss << "Invalid index: no pedestal mean exist @ " << i;
       throw OpticalRecoException(ss.str());
     }
-    return _mean_v[i];
+    return _model.Mean(i);
   }
 
   //*******************************************
   double PMTPedestalBase::Sigma(size_t i) const
   //*******************************************
   {
-    if (i > _sigma_v.size()) {
+    if (i >= _model.size()) {
       std::stringstream ss;
       ss << "Invalid index: no pedestal sigma exist @ " << i;
       throw OpticalRecoException(ss.str());
     }
-    return _sigma_v[i];
+    return _model.Sigma(i);
   }
 
   //*************************************************
   const PedestalMean_t& PMTPedestalBase::Mean() const
   //*************************************************
   {
-    return _mean_v;
+    return _model.MeanArray();
   }
 
   //***************************************************
   const PedestalSigma_t& PMTPedestalBase::Sigma() const
   //***************************************************
   {
-    return _sigma_v;
+    return _model.SigmaArray();
   }
+
+  //***************************************************
+  const PedestalModel& PMTPedestalBase::Model() const
+  //***************************************************
+  {
+    return _model;
+  }
+
+  //***********************************
+  void PMTPedestalBase::ResetStats()
+  //***********************************
+  {
+    _stats = AlgoStats();
+    _stats.name = _name;
+  }
+
 }
@@ -16,6 +16,8 @@
 
 // STL
 #include "OpticalRecoTypes.h"
+#include "PedestalModel.h"
+#include "PulseRecoStats.h"
 #include <string>
 
 namespace pmtana {
@@ -37,7 +39,7 @@ namespace pmtana {
     const std::string& Name() const;
 
     /// Method to compute a pedestal
-    bool Evaluate(const pmtana::Waveform_t& wf);
+    bool Evaluate(pmtana::WaveformView_t wf);
 
     /// Getter of the pedestal mean value
     double Mean(size_t i) const;
@@ -45,30 +47,68 @@ namespace pmtana {
     /// Getter of the pedestal standard deviation
     double Sigma(size_t i) const;
 
-    /// Getter of the pedestal mean value
+    /// Getter of the pedestal mean value (per-sample array, expanded from the model if needed)
     const pmtana::PedestalMean_t& Mean() const;
 
-    /// Getter of the pedestal standard deviation
+    /// Getter of the pedestal standard deviation (per-sample array, expanded from the model if needed)
     const pmtana::PedestalSigma_t& Sigma() const;
 
+    /// Getter of the pedestal in its compact form
+    const pmtana::PedestalModel& Model() const;
+
+    /// Enables or disables the collection of execution statistics
+    void EnableStats(bool enable) { _collect_stats = enable; }
+
+    /// Execution statistics collected so far
+    const pmtana::AlgoStats& Stats() const { return _stats; }
+
+    /// Clears the execution statistics
+    void ResetStats();
+
+    /// Sets the channel of the next waveforms to be evaluated (-1 if unknown)
+    void SetChannel(int channel) { _channel = channel; }
+
+    /// Channel of the waveform being evaluated (-1 if unknown)
+    int Channel() const { return _channel; }
+
+    /// Notifies the start of a new event, for algorithms keeping state across waveforms
+    /// (it may be called more than once per event)
+    virtual void NewEvent() {}
+
+    /// Whether the pedestal of a waveform depends on the waveforms evaluated before it
+    virtual bool DependsOnPreviousWaveforms() const { return false; }
+
+    /// Whether the pedestal always lies within the range of the waveform samples
+    virtual bool PedestalWithinSampleRange() const { return true; }
+
   protected:
     /**
        Method to compute pedestal: mean and sigma array should be filled per ADC.
        The length of each array is guaranteed to be same.
     */
-    virtual bool ComputePedestal(const ::pmtana::Waveform_t& wf,
+    virtual bool ComputePedestal(pmtana::WaveformView_t wf,
                                  pmtana::PedestalMean_t& mean_v,
                                  pmtana::PedestalSigma_t& sigma_v) = 0;
 
+    /**
+       Method to compute pedestal in a compact form, for algorithms whose result has a simple shape.
+       The default implementation fills a dense model with ComputePedestal().
+    */
+    virtual bool ComputePedestalModel(pmtana::WaveformView_t wf, pmtana::PedestalModel& model);
+
   private:
     /// Name
     std::string _name;
 
-    /// A variable holder for pedestal mean value
-    pmtana::PedestalMean_t _mean_v;
+    /// A variable holder for pedestal mean value and standard deviation
+    pmtana::PedestalModel _model;
+
+    /// Whether execution statistics are collected, and the statistics
+    bool _collect_stats = false;
+    pmtana::AlgoStats _stats;
 
-    /// A variable holder for pedestal standard deviation
-    pmtana::PedestalSigma_t _sigma_v;
+    /// Channel of the waveform being evaluated
+    int _channel = -1;
   };
 }
 #endif
@@ -16,6 +16,7 @@ namespace pmtana {
   //*************************************************************************
   {
     Reset();
+    ResetStats();
   }
 
   //***********************************************
@@ -33,17 +34,75 @@ namespace pmtana {
   }
 
   //******************************************************************
-  bool PMTPulseRecoBase::Reconstruct(const Waveform_t& wf,
-                                     const PedestalMean_t& mean_v,
-                                     const PedestalSigma_t& sigma_v)
+  bool PMTPulseRecoBase::Reconstruct(WaveformView_t wf,
+                                     PedestalMeanView_t mean_v,
+                                     PedestalSigmaView_t sigma_v)
   //******************************************************************
   {
+    if (!_collect_stats) {
+      _status = this->RecoPulse(wf, mean_v, sigma_v);
+      return _status;
+    }
+
+    auto const start = StatsClock_t::now();
     _status = this->RecoPulse(wf, mean_v, sigma_v);
+    _stats.time += SecondsSince(start);
+    ++_stats.n_waveforms;
+    _stats.n_samples += wf.size();
+    _stats.n_pulses += _pulse_v.size();
     return _status;
   }
 
+  //******************************************************************
+  bool PMTPulseRecoBase::Reconstruct(WaveformView_t wf, const PedestalModel& ped)
+  //******************************************************************
+  {
+    if (!_collect_stats) {
+      _status = this->RecoPulseModel(wf, ped);
+      return _status;
+    }
+
+    auto const start = StatsClock_t::now();
+    _status = this->RecoPulseModel(wf, ped);
+    _stats.time += SecondsSince(start);
+    ++_stats.n_waveforms;
+    _stats.n_samples += wf.size();
+    _stats.n_pulses += _pulse_v.size();
+    return _status;
+  }
+
+  //******************************************************************
+  double PMTPulseRecoBase::RiseTime(WaveformView_t wf_pulse,
+                                    PedestalMeanView_t ped_pulse,
+                                    bool positive)
+  //******************************************************************
+  {
+    if (!_collect_stats) return _risetime_calc_ptr->RiseTime(wf_pulse, ped_pulse, positive);
+
+    auto const start = StatsClock_t::now();
+    double const rise_time = _risetime_calc_ptr->RiseTime(wf_pulse, ped_pulse, positive);
+    _stats.risetime_time += SecondsSince(start);
+    ++_stats.n_risetime;
+    return rise_time;
+  }
+
+  //***************************************************************
+  void PMTPulseRecoBase::ResetStats()
+  //***************************************************************
+  {
+    _stats = AlgoStats();
+    _stats.name = _name;
+  }
+
+  //******************************************************************
+  bool PMTPulseRecoBase::RecoPulseModel(WaveformView_t wf, const PedestalModel& ped)
+  //******************************************************************
+  {
+    return this->RecoPulse(wf, ped.MeanView(), ped.SigmaView());
+  }
+
   //*****************************************************************************
-  bool CheckIndex(const std::vector<short>& wf, const size_t& begin, size_t& end)
+  bool CheckIndex(WaveformView_t wf, const size_t& begin, size_t& end)
   //*****************************************************************************
   {
     if (begin >= wf.size() || end >= wf.size() || begin > end) {
@@ -95,7 +154,7 @@ namespace pmtana {
   }
 
   //***************************************************************
-  bool PMTPulseRecoBase::Integral(const std::vector<short>& wf,
+  bool PMTPulseRecoBase::Integral(WaveformView_t wf,
                                   double& result,
                                   size_t begin,
                                   size_t end) const
@@ -104,9 +163,9 @@ namespace pmtana {
 
     if (!CheckIndex(wf, begin, end)) return false;
 
-    std::vector<short>::const_iterator begin_iter(wf.begin());
+    WaveformView_t::const_iterator begin_iter(wf.begin());
 
-    std::vector<short>::const_iterator end_iter(wf.begin());
+    WaveformView_t::const_iterator end_iter(wf.begin());
 
     begin_iter = begin_iter + begin;
 
@@ -118,7 +177,7 @@ namespace pmtana {
   }
 
   //***************************************************************
-  bool PMTPulseRecoBase::Derivative(const std::vector<short>& wf,
+  bool PMTPulseRecoBase::Derivative(WaveformView_t wf,
                                     std::vector<int32_t>& diff,
                                     size_t begin,
                                     size_t end) const
@@ -141,7 +200,7 @@ namespace pmtana {
   }
 
   //***************************************************************
-  size_t PMTPulseRecoBase::Max(const std::vector<short>& wf,
+  size_t PMTPulseRecoBase::Max(WaveformView_t wf,
                                double& result,
                                size_t begin,
                                size_t end) const
@@ -166,7 +225,7 @@ namespace pmtana {
   }
 
   //***************************************************************
-  size_t PMTPulseRecoBase::Min(const std::vector<short>& wf,
+  size_t PMTPulseRecoBase::Min(WaveformView_t wf,
                                double& result,
                                size_t begin,
                                size_t end) const
@@ -20,6 +20,8 @@
 #include <vector>
 
 #include "OpticalRecoTypes.h"
+#include "PedestalModel.h"
+#include "PulseRecoStats.h"
 #include "larana/OpticalDetector/OpHitFinder/RiseTimeTools/RiseTimeCalculatorBase.h"
 
 #include <memory>
@@ -53,8 +55,8 @@ namespace pmtana {
    The base class of pulse reconstruction algorithms. All algorithms should inherit from this calss
    to be executed by a manager class, pulse_reco. Note that this class does not depend on the rest
    of the framework except for the use of constants. In order to reconstruct a pulse, all it requires
-   is a std::vector<short> type object (i.e. raw waveform), waveform pedestal, and its standard
-   deviation. All of these are to be provided by an executer. Reconstructed pulse parameters are
+   is a view of the raw waveform (pmtana::WaveformView_t, which does not copy the samples),
+   waveform pedestal, and its standard deviation. All of these are to be provided by an executer. Reconstructed pulse parameters are
    stored in the pulse_param struct object.
 
    All methods specified as "virtual" should be implemented by the inherit children class.
@@ -84,9 +86,12 @@ namespace pmtana {
     /** A core method: this executes the algorithm and stores reconstructed parameters
       in the pulse_param struct object.
     */
-    bool Reconstruct(const pmtana::Waveform_t&,
-                     const pmtana::PedestalMean_t&,
-                     const pmtana::PedestalSigma_t&);
+    bool Reconstruct(pmtana::WaveformView_t,
+                     pmtana::PedestalMeanView_t,
+                     pmtana::PedestalSigmaView_t);
+
+    /// Same as above, with the pedestal in its compact form.
+    bool Reconstruct(pmtana::WaveformView_t, const pmtana::PedestalModel&);
 
     /** A getter for the pulse_param struct object.
       Reconstruction algorithm may have more than one pulse reconstructed from an input waveform.
@@ -100,6 +105,28 @@ namespace pmtana {
     /// A getter for the number of reconstructed pulses from the input waveform
     size_t GetNPulse() const { return _pulse_v.size(); };
 
+    /**
+      Smallest peak-to-peak ADC range a waveform must have for this algorithm to find any pulse,
+      provided that its pedestal lies within the range of the waveform samples.
+      Used to skip quiet waveforms; the default, 0, means that any waveform may have pulses.
+    */
+    virtual double MinPulseExcursion() const { return 0.; }
+
+    /// Whether the rise time calculator, if any, can be used from several threads at once
+    bool RiseTimeThreadSafe() const
+    {
+      return !_risetime_calc_ptr || _risetime_calc_ptr->ThreadSafe();
+    }
+
+    /// Enables or disables the collection of execution statistics
+    void EnableStats(bool enable) { _collect_stats = enable; }
+
+    /// Execution statistics collected so far
+    const pmtana::AlgoStats& Stats() const { return _stats; }
+
+    /// Clears the execution statistics
+    void ResetStats();
+
   private:
     /// Unique name
     std::string _name;
@@ -107,10 +134,21 @@ namespace pmtana {
     /// Status after pulse reconstruction
     bool _status;
 
+    /// Whether execution statistics are collected, and the statistics
+    bool _collect_stats = false;
+    pmtana::AlgoStats _stats;
+
   protected:
-    virtual bool RecoPulse(const pmtana::Waveform_t&,
-                           const pmtana::PedestalMean_t&,
-                           const pmtana::PedestalSigma_t&) = 0;
+    virtual bool RecoPulse(pmtana::WaveformView_t,
+                           pmtana::PedestalMeanView_t,
+                           pmtana::PedestalSigmaView_t) = 0;
+
+    /**
+     Pulse reconstruction from a compact pedestal. Algorithms which do not need the pedestal of
+     every sample should override this; the default implementation calls RecoPulse() with the
+     pedestal expanded to per-sample arrays.
+    */
+    virtual bool RecoPulseModel(pmtana::WaveformView_t, const pmtana::PedestalModel&);
 
     /// A container array of pulse_param struct objects to store (possibly multiple) reconstructed pulse(s).
     pulse_param_array _pulse_v;
@@ -121,12 +159,23 @@ namespace pmtana {
     /// Tool for rise time calculation
     std::unique_ptr<pmtana::RiseTimeCalculatorBase> _risetime_calc_ptr = nullptr;
 
+    /// Rise time of a pulse from the calculator tool, which must be set
+    double RiseTime(pmtana::WaveformView_t wf_pulse,
+                    pmtana::PedestalMeanView_t ped_pulse,
+                    bool positive);
+
+    /// To be called for each pulse candidate discarded by the algorithm, for the statistics
+    void CountRejectedPulse()
+    {
+      if (_collect_stats) ++_stats.n_rejected;
+    }
+
   protected:
     /**
      A method to integrate an waveform from index "begin" to the "end". The result is filled in "result" reference.
      If the "end" is default (=0), then "end" is set to the last index of the waveform.
     */
-    bool Integral(const std::vector<short>& wf,
+    bool Integral(WaveformView_t wf,
                   double& result,
                   size_t begin = 0,
                   size_t end = 0) const;
@@ -135,7 +184,7 @@ namespace pmtana {
      A method to compute derivative, which is a simple subtraction of previous ADC sample from each sample.
      The result is stored in the input "diff" reference vector which is int32_t type as a derivative could be negative.
     */
-    bool Derivative(const std::vector<short>& wf,
+    bool Derivative(WaveformView_t wf,
                     std::vector<int32_t>& diff,
                     size_t begin = 0,
                     size_t end = 0) const;
@@ -144,7 +193,7 @@ namespace pmtana {
      A method to return the maximum value of ADC sample within the index from "begin" to "end".
      If the "end" is default (=0), then "end" is set to the last index of the waveform.
     */
-    size_t Max(const std::vector<short>& wf,
+    size_t Max(WaveformView_t wf,
                double& result,
                size_t begin = 0,
                size_t end = 0) const;
@@ -153,7 +202,7 @@ namespace pmtana {
      A method to return the minimum value of ADC sample within the index from "begin" to "end".
      If the "end" is default (=0), then "end" is set to the last index of the waveform.
     */
-    size_t Min(const std::vector<short>& wf,
+    size_t Min(WaveformView_t wf,
                double& result,
                size_t begin = 0,
                size_t end = 0) const;
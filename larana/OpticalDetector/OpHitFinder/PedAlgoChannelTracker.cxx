@@ -0,0 +1,152 @@
+////////////////////////////////////////////////////////////////////////
+//
+//  PedAlgoChannelTracker source
+//
+////////////////////////////////////////////////////////////////////////
+
+#include "fhiclcpp/ParameterSet.h"
+
+#include "OpticalRecoException.h"
+#include "PedAlgoChannelTracker.h"
+#include "PedAlgoEdges.h"
+#include "PedAlgoRmsSlider.h"
+#include "PedAlgoRollingMean.h"
+#include "PedAlgoUB.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+  /// Creates the pedestal algorithm configured in `pset`, by its `Name`.
+  std::unique_ptr<pmtana::PMTPedestalBase> MakeFullEstimateAlgo(const fhicl::ParameterSet& pset)
+  {
+    auto const name = pset.get<std::string>("Name");
+    if (name == "Edges") return std::make_unique<pmtana::PedAlgoEdges>(pset);
+    if (name == "RollingMean") return std::make_unique<pmtana::PedAlgoRollingMean>(pset);
+    if (name == "RmsSlider") return std::make_unique<pmtana::PedAlgoRmsSlider>(pset);
+    if (name == "UB") return std::make_unique<pmtana::PedAlgoUB>(pset);
+    throw pmtana::OpticalRecoException("PedAlgoChannelTracker: unsupported FullEstimateAlgo \"" +
+                                       name + "\"!");
+  }
+
+}
+
+namespace pmtana {
+
+  //*****************************************************************************
+  PedAlgoChannelTracker::PedAlgoChannelTracker(const fhicl::ParameterSet& pset,
+                                               const std::string name)
+    : PMTPedestalBase(name)
+  //*****************************************************************************
+  {
+    _full_algo = MakeFullEstimateAlgo(pset.get<fhicl::ParameterSet>("FullEstimateAlgo"));
+
+    _check_samples = pset.get<size_t>("CheckSamples");
+    _max_deviation = pset.get<double>("MaxDeviation");
+    _nsigma_deviation = pset.get<double>("NSigmaDeviation", 3.);
+    _update_weight = pset.get<double>("UpdateWeight", 0.05);
+    _across_events = pset.get<bool>("TrackAcrossEvents", false);
+
+    if (_check_samples < 2)
+      throw OpticalRecoException("PedAlgoChannelTracker: CheckSamples must be at least 2!");
+    if (_update_weight < 0. || _update_weight > 1.)
+      throw OpticalRecoException("PedAlgoChannelTracker: UpdateWeight must be in [ 0, 1 ]!");
+  }
+
+  //*******************************************
+  void PedAlgoChannelTracker::NewEvent()
+  //*******************************************
+  {
+    if (_across_events) return;
+    for (auto& baseline : _baseline_v)
+      baseline.valid = false;
+  }
+
+  //*****************************************************************************
+  bool PedAlgoChannelTracker::ComputePedestal(pmtana::WaveformView_t wf,
+                                              pmtana::PedestalMean_t& mean_v,
+                                              pmtana::PedestalSigma_t& sigma_v)
+  //*****************************************************************************
+  {
+    if (!ComputePedestalModel(wf, _array_model)) return false;
+
+    mean_v = _array_model.MeanArray();
+    sigma_v = _array_model.SigmaArray();
+    return true;
+  }
+
+  //*****************************************************************************************
+  bool PedAlgoChannelTracker::ComputePedestalModel(pmtana::WaveformView_t wf,
+                                                   pmtana::PedestalModel& model)
+  //*****************************************************************************************
+  {
+    int const channel = Channel();
+    if (channel < 0) return FullEstimate(wf, model, nullptr);
+
+    if ((size_t)channel >= _baseline_v.size()) _baseline_v.resize(channel + 1);
+    ChannelBaseline& baseline = _baseline_v[channel];
+
+    size_t const nsamples = std::min(_check_samples, wf.size());
+    if (!baseline.valid || nsamples < 2) return FullEstimate(wf, model, &baseline);
+
+    // compare the start of the fragment with the tracked baseline
+    double mean = 0;
+    for (size_t i = 0; i < nsamples; ++i)
+      mean += wf[i];
+    mean /= nsamples;
+
+    double variance = 0;
+    for (size_t i = 0; i < nsamples; ++i)
+      variance += (wf[i] - mean) * (wf[i] - mean);
+    variance /= (nsamples - 1); // unbiased, not to underestimate sigma over time
+
+    double const allowed =
+      std::max(_max_deviation, _nsigma_deviation * std::sqrt(baseline.variance));
+    if (std::abs(mean - baseline.mean) > allowed) return FullEstimate(wf, model, &baseline);
+
+    baseline.mean += _update_weight * (mean - baseline.mean);
+    baseline.variance += _update_weight * (variance - baseline.variance);
+    ++_n_tracked;
+
+    model.SetConstant(wf.size(), baseline.mean, std::sqrt(baseline.variance));
+    return true;
+  }
+
+  //*****************************************************************************
+  bool PedAlgoChannelTracker::FullEstimate(pmtana::WaveformView_t wf,
+                                           pmtana::PedestalModel& model,
+                                           ChannelBaseline* baseline)
+  //*****************************************************************************
+  {
+    ++_n_full;
+
+    _full_algo->SetChannel(Channel());
+    bool const status = _full_algo->Evaluate(wf);
+    PedestalModel const& full = _full_algo->Model();
+    model = full;
+
+    if (!baseline) return status;
+
+    baseline->valid = status && full.size() > 0;
+    if (!baseline->valid) return status;
+
+    // the new baseline is the average of the full estimate over the fragment
+    if (full.IsConstant()) {
+      baseline->mean = full.Mean(0);
+      baseline->variance = full.Sigma(0) * full.Sigma(0);
+    }
+    else {
+      double mean = 0, variance = 0;
+      for (size_t i = 0; i < full.size(); ++i) {
+        mean += full.Mean(i);
+        variance += full.Sigma(i) * full.Sigma(i);
+      }
+      baseline->mean = mean / full.size();
+      baseline->variance = variance / full.size();
+    }
+
+    return status;
+  }
+
+}
@@ -0,0 +1,109 @@
+/**
+ * \file PedAlgoChannelTracker.h
+ *
+ * \ingroup PulseReco
+ *
+ * \brief Class definition file of PedAlgoChannelTracker
+ */
+
+/** \addtogroup PulseReco
+
+@{*/
+
+#ifndef larana_OPTICALDETECTOR_PEDALGOCHANNELTRACKER_H
+#define larana_OPTICALDETECTOR_PEDALGOCHANNELTRACKER_H
+
+#include "PMTPedestalBase.h"
+namespace fhicl {
+  class ParameterSet;
+}
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace pmtana {
+
+  /**
+   \class PedAlgoChannelTracker
+   Pedestal of waveform fragments from a continuous or self-triggered readout, tracked per channel.
+
+   Each channel keeps a baseline mean and variance, updated with an exponential moving average from
+   the first `CheckSamples` samples of each of its fragments. If these samples agree with the
+   tracked baseline within `max(MaxDeviation, NSigmaDeviation x sigma)`, the fragment pedestal is
+   the (updated) tracked baseline, constant; otherwise, the pedestal is evaluated by the full
+   estimate algorithm configured in `FullEstimateAlgo` (one of "Edges", "RollingMean", "RmsSlider"
+   and "UB"), and the tracked baseline is reset to its average.
+
+   The variance of the first samples is the unbiased one, so `CheckSamples` must be at least 2.
+
+   The channel must be set with SetChannel() before each evaluation: without it (channel -1) the
+   full estimate is always used. The baselines are cleared on NewEvent(), unless
+   `TrackAcrossEvents` is set. Since the result depends on the fragments seen before, the same
+   instance must process all the fragments of a channel, in order, for reproducible results:
+   the algorithm can't be used by the multi-threaded hit finder, nor with the skipping of quiet
+   waveforms, which assumes the pedestal within the range of the samples.
+  */
+  class PedAlgoChannelTracker : public PMTPedestalBase {
+
+  public:
+    /// Alternative ctor
+    PedAlgoChannelTracker(const fhicl::ParameterSet& pset,
+                          const std::string name = "PedChannelTracker");
+
+    /// Clears the tracked baselines, unless they are kept across events.
+    void NewEvent();
+
+    /// The pedestal depends on the fragments of the channel seen before.
+    bool DependsOnPreviousWaveforms() const { return true; }
+
+    /// The tracked baseline may lie outside the range of the fragment samples.
+    bool PedestalWithinSampleRange() const { return false; }
+
+    /// Number of fragments whose pedestal was the tracked baseline
+    size_t NTrackedEstimates() const { return _n_tracked; }
+
+    /// Number of fragments whose pedestal was evaluated by the full estimate algorithm
+    size_t NFullEstimates() const { return _n_full; }
+
+  protected:
+    /// Per-sample arrays of the pedestal from ComputePedestalModel().
+    bool ComputePedestal(pmtana::WaveformView_t wf,
+                         pmtana::PedestalMean_t& mean_v,
+                         pmtana::PedestalSigma_t& sigma_v);
+
+    /// Constant pedestal from the tracked baseline, or the full estimate.
+    bool ComputePedestalModel(pmtana::WaveformView_t wf, pmtana::PedestalModel& model);
+
+  private:
+    /// Baseline tracked on a channel
+    struct ChannelBaseline {
+      bool valid = false;
+      double mean = 0.;
+      double variance = 0.;
+    };
+
+    /// Runs the full estimate algorithm and resets `baseline` (if any) to its result.
+    bool FullEstimate(pmtana::WaveformView_t wf,
+                      pmtana::PedestalModel& model,
+                      ChannelBaseline* baseline);
+
+    std::unique_ptr<PMTPedestalBase> _full_algo; ///< Algorithm used when the baseline is off
+
+    PedestalModel _array_model; ///< Model behind ComputePedestal(), reused across waveforms
+
+    size_t _check_samples;    ///< Samples at the start of a fragment compared to the baseline
+    double _max_deviation;    ///< Minimum allowed deviation from the baseline [ADC]
+    double _nsigma_deviation; ///< Allowed deviation from the baseline, in baseline sigma
+    double _update_weight;    ///< Weight of a new fragment in the baseline average
+    bool _across_events;      ///< Whether baselines are kept from one event to the next
+
+    std::vector<ChannelBaseline> _baseline_v; ///< Baselines, indexed by channel
+
+    size_t _n_tracked = 0;
+    size_t _n_full = 0;
+  };
+}
+#endif
+
+/** @} */ // end of doxygen group
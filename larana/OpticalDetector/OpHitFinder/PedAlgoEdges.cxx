@@ -40,7 +40,7 @@ namespace pmtana {
   }
 
   //*********************************************************************
-  bool PedAlgoEdges::ComputePedestal(const pmtana::Waveform_t& wf,
+  bool PedAlgoEdges::ComputePedestal(pmtana::WaveformView_t wf,
                                      pmtana::PedestalMean_t& mean_v,
                                      pmtana::PedestalSigma_t& sigma_v)
   //*********************************************************************
@@ -48,22 +48,45 @@ namespace pmtana {
 
     double ped_mean = 0;
     double ped_sigma = 0;
+    EdgesPedestal(wf, ped_mean, ped_sigma);
+
+    for (auto& v : mean_v)
+      v = ped_mean;
+    for (auto& v : sigma_v)
+      v = ped_sigma;
+
+    return true;
+  }
+
+  //*********************************************************************
+  bool PedAlgoEdges::ComputePedestalModel(pmtana::WaveformView_t wf, pmtana::PedestalModel& model)
+  //*********************************************************************
+  {
+
+    double ped_mean = 0;
+    double ped_sigma = 0;
+    EdgesPedestal(wf, ped_mean, ped_sigma);
+
+    model.SetConstant(wf.size(), ped_mean, ped_sigma);
+
+    return true;
+  }
+
+  //*********************************************************************
+  void PedAlgoEdges::EdgesPedestal(pmtana::WaveformView_t wf,
+                                   double& ped_mean,
+                                   double& ped_sigma) const
+  //*********************************************************************
+  {
+
     switch (_method) {
     case kHEAD:
       ped_mean = mean(wf, 0, _nsample_front);
       ped_sigma = std(wf, ped_mean, 0, _nsample_front);
-      for (auto& v : mean_v)
-        v = ped_mean;
-      for (auto& v : sigma_v)
-        v = ped_sigma;
       break;
     case kTAIL:
       ped_mean = mean(wf, (wf.size() - _nsample_tail), _nsample_tail);
       ped_sigma = std(wf, ped_mean, (wf.size() - _nsample_tail), _nsample_tail);
-      for (auto& v : mean_v)
-        v = ped_mean;
-      for (auto& v : sigma_v)
-        v = ped_sigma;
       break;
     case kBOTH:
       double ped_mean_head = mean(wf, 0, _nsample_front);
@@ -77,13 +100,8 @@ namespace pmtana {
         ped_mean = ped_mean_tail;
         ped_sigma = ped_sigma_tail;
       }
-      for (auto& v : mean_v)
-        v = ped_mean;
-      for (auto& v : sigma_v)
-        v = ped_sigma;
       break;
     }
-    return true;
   }
 
 }
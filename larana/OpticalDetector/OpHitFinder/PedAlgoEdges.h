@@ -49,11 +49,17 @@ namespace pmtana {
 
   protected:
     /// Method to compute a pedestal of the input waveform using "nsample" ADC samples from "start" index.
-    bool ComputePedestal(const pmtana::Waveform_t& wf,
+    bool ComputePedestal(pmtana::WaveformView_t wf,
                          pmtana::PedestalMean_t& mean_v,
                          pmtana::PedestalSigma_t& sigma_v);
 
+    /// The pedestal is a constant.
+    bool ComputePedestalModel(pmtana::WaveformView_t wf, pmtana::PedestalModel& model);
+
   private:
+    /// Computes the constant pedestal mean and standard deviation.
+    void EdgesPedestal(pmtana::WaveformView_t wf, double& ped_mean, double& ped_sigma) const;
+
     size_t _nsample_front; ///< # ADC sample in front to be used
     size_t _nsample_tail;  ///< # ADC sample in tail to be used
     PED_METHOD _method;    ///< Methods
@@ -55,44 +55,7 @@ namespace pmtana {
   }
 
   //****************************************************************************
-  double PedAlgoRmsSlider::CalcMean(const std::vector<double>& wf, size_t start, size_t nsample)
-  //****************************************************************************
-  {
-    if (!nsample) nsample = wf.size();
-    if (start > wf.size() || (start + nsample) > wf.size())
-      throw OpticalRecoException("Invalid start/end index!");
-
-    double sum = std::accumulate(wf.begin() + start, wf.begin() + start + nsample, 0.0);
-
-    sum /= ((double)nsample);
-
-    return sum;
-  }
-
-  //****************************************************************************
-  double PedAlgoRmsSlider::CalcStd(const std::vector<double>& wf,
-                                   const double ped_mean,
-                                   size_t start,
-                                   size_t nsample)
-  //****************************************************************************
-  {
-    if (!nsample) nsample = wf.size();
-    if (start > wf.size() || (start + nsample) > wf.size())
-      throw OpticalRecoException("Invalid start/end index!");
-
-    double sigma = 0;
-
-    for (size_t index = start; index < (start + nsample); ++index) {
-      sigma += pow((wf[index] - ped_mean), 2);
-    }
-
-    sigma = sqrt(sigma / ((double)(nsample)));
-
-    return sigma;
-  }
-
-  //****************************************************************************
-  bool PedAlgoRmsSlider::ComputePedestal(const pmtana::Waveform_t& wf,
+  bool PedAlgoRmsSlider::ComputePedestal(pmtana::WaveformView_t wf,
                                          pmtana::PedestalMean_t& mean_v,
                                          pmtana::PedestalSigma_t& sigma_v)
   //****************************************************************************
@@ -111,52 +74,55 @@ namespace pmtana {
     // the wf itself
     // **********
 
-    pmtana::PedestalMean_t mean_temp_v;
-    mean_temp_v.resize(wf.size(), 0);
+    auto& mean_temp_v = _mean_temp_v;
+    mean_temp_v.assign(wf.begin(), wf.end());
 
-    for (size_t i = 0; i < wf.size(); ++i) {
-      mean_temp_v[i] = wf[i];
+    for (size_t i = 0; i < wf.size(); ++i)
       sigma_v[i] = 0;
-    }
 
     // **********
     // Now look for rms variations
     // and change the mean and rms accordingly
     // **********
     int last_good_index = -1;
-    double local_mean, local_rms;
-    std::vector<double> local_mean_v(wf.size(), -1.);
-    std::vector<double> local_sigma_v(wf.size(), -1.);
 
-    for (size_t i = 0; i < wf.size() - _sample_size; i++) {
+    // local mean and rms of all the windows, in a single pass;
+    // windows with rms above threshold are then flagged as -1
+    auto& local_mean_v = _local_mean_v;
+    auto& local_sigma_v = _local_sigma_v;
+    sliding_mean_std(wf, _sample_size, local_mean_v, local_sigma_v);
+    local_mean_v.back() = local_sigma_v.back() = -1.; // last window is never used
 
-      local_mean = mean(wf, i, _sample_size);
-      local_rms = std(wf, local_mean, i, _sample_size);
+    for (size_t i = 0; i < wf.size() - _sample_size; i++) {
 
       if (_verbose)
-        std::cout << "\033[93mPedAlgoRmsSlider\033[00m: i " << i << "  local_mean: " << local_mean
-                  << "  local_rms: " << local_rms << std::endl;
+        std::cout << "\033[93mPedAlgoRmsSlider\033[00m: i " << i
+                  << "  local_mean: " << local_mean_v[i] << "  local_rms: " << local_sigma_v[i]
+                  << std::endl;
 
-      if (local_rms < _threshold) {
-
-        local_mean_v[i] = local_mean;
-        local_sigma_v[i] = local_rms;
+      if (local_sigma_v[i] < _threshold) {
 
         if (_verbose)
           std::cout << "\033[93mBelow threshold\033[00m: "
                     << "at i " << i << " last good index was: " << last_good_index << std::endl;
       }
+      else {
+        local_mean_v[i] = -1.;
+        local_sigma_v[i] = -1.;
+      }
     }
 
     // find the gaps (regions to be interpolated
     last_good_index = -1;
-    std::vector<bool> ped_interapolated(wf.size(), false);
+    auto& ped_interapolated = _ped_interpolated;
+    ped_interapolated.assign(wf.size(), false);
     for (size_t i = 0; i < wf.size() - _sample_size; i++) {
 
       if (local_mean_v[i] > -0.1) {
         // good pedestal!
 
-        if ((last_good_index + 1) < (int)i) {
+        // (a gap at the start of the waveform is treated below)
+        if (last_good_index >= 0 && (last_good_index + 1) < (int)i) {
           // finished the gap. try interpolation
           // 0) find where to start/end interpolation
           int start_tick = last_good_index;
@@ -192,70 +158,6 @@ namespace pmtana {
       }
     }
 
-    /*
-
-    for (size_t i = 0; i < wf.size() - _sample_size; i++) {
-
-      local_mean = mean(wf, i, _sample_size);
-      local_rms  = std(wf, local_mean, i, _sample_size);
-
-      if(_verbose) std::cout << "\033[93mPedAlgoRmsSlider\033[00m: i " << i << "  local_mean: " << local_mean << "  local_rms: " << local_rms << std::endl;
-
-      if (local_rms < _threshold) {
-
-	local_mean_v[i] = local_mean;
-	local_sigma_v[i] = local_sigma;
-
-        if(_verbose)
-          std::cout << "\033[93mBelow threshold\033[00m: "
-                    << "at i " << i
-                    << " last good index was: " << last_good_index
-                    << std::endl;
-
-        if(last_good_index<0) {
-          last_good_index = (int)i;
-          last_local_mean = local_mean;
-          last_local_rms  = local_rms;
-          continue;
-        }
-
-
-        if( ( last_good_index + 1 ) < (int)i ) {
-
-          //this should become generic interpolation function, for now lets leave.
-          float slope = (local_mean - last_local_mean) / (float(i - last_good_index));
-
-          for(size_t j = last_good_index + 1; j < i && j < wf.size(); ++j) {
-            mean_temp_v.at(j)  = slope * ( float(j - last_good_index) ) + mean_temp_v.at(last_good_index);
-            // for sigma, put either the sigma in the region before the pulse or
-            // after the pulse, depending on which one if != 0. If both are !=0 put the one after
-            // the pulse (just default), if both are zero then put zero
-            sigma_v.at(j) = (local_rms != 0 ? local_rms : last_local_rms); // todo: fluctuate baseline
-            ped_interapolated.at(j) = true;
-          }
-        }
-
-	// record this mean & rms as good mean value
-        last_good_index = i;
-        last_local_mean = local_mean;
-        last_local_rms  = local_rms;
-	// if _num_postsample is specified, go back in time to look for it
-	if(_num_postsample >0 && (i>_num_postsample)) {
-	  int loop_start = std::max(((int)i) - _num_postsample, 0);
-	  for(int j=loop_start; j>=0; --j) {
-	    if(local_mean_v[j] <0) continue;
-	    last_good_index = j;
-	    last_local_mean = local_mean_v[j];
-	    last_local_rms  = local_sigma_v[j];
-	    break;
-	  }
-	}
-      }
-
-
-    }
-     */
-
     // **********
     // Now look at special cases, if wf starts or
     // ends with a pulse
@@ -265,23 +167,17 @@ namespace pmtana {
 
     bool end_found = false;
 
-    local_mean = mean(wf, 0, _sample_size);
-    local_rms = std(wf, local_mean, 0, _sample_size);
-
-    if (local_rms >= _threshold) {
+    if (local_mean_v[0] < 0) {
 
       for (size_t i = 1; i < wf.size() - _sample_size; i++) {
 
-        local_mean = mean(wf, i, _sample_size);
-        local_rms = std(wf, local_mean, i, _sample_size);
-
-        if (local_rms < _threshold) {
+        if (local_mean_v[i] >= 0) {
 
           end_found = true;
 
           for (size_t j = 0; j < i; j++) {
-            mean_temp_v[j] = local_mean;
-            sigma_v[j] = local_rms;
+            mean_temp_v[j] = local_mean_v[i];
+            sigma_v[j] = local_sigma_v[i];
             ped_interapolated[j] = true;
           }
           break;
@@ -301,23 +197,18 @@ namespace pmtana {
 
     bool start_found = false;
 
-    local_mean = mean(wf, wf.size() - 1 - _sample_size, _sample_size);
-    local_rms = std(wf, local_mean, wf.size() - 1 - _sample_size, _sample_size);
-
-    if (local_rms >= _threshold) {
+    if (local_mean_v[wf.size() - 1 - _sample_size] < 0) {
 
       size_t i = wf.size() - 1 - _sample_size;
       while (i-- > 0) {
-        local_mean = mean(wf, i, _sample_size);
-        local_rms = std(wf, local_mean, i, _sample_size);
 
-        if (local_rms < _threshold) {
+        if (local_mean_v[i] >= 0) {
 
           start_found = true;
 
           for (size_t j = wf.size() - 1; j > i; j--) {
-            mean_temp_v[j] = local_mean;
-            sigma_v[j] = local_rms;
+            mean_temp_v[j] = local_mean_v[i];
+            sigma_v[j] = local_sigma_v[i];
             ped_interapolated[j] = true;
           }
           break;
@@ -339,15 +230,13 @@ namespace pmtana {
 
     const size_t window_size = _sample_size * 2;
 
-    // middle mean
-    for (size_t i = 0; i < mean_temp_v.size(); ++i) {
+    // middle mean: window starting at (i - _sample_size) for each tick i
+    sliding_mean_std(mean_temp_v, window_size, _smooth_mean_v, _smooth_sigma_v);
 
-      if (i < _sample_size || i >= (wf.size() - _sample_size)) continue;
+    for (size_t i = _sample_size; i < wf.size() - _sample_size; ++i) {
 
-      mean_v[i] = this->CalcMean(mean_temp_v, i - _sample_size, window_size);
-      if (!ped_interapolated[i]) {
-        sigma_v[i] = this->CalcStd(mean_temp_v, mean_v[i], i - _sample_size, window_size);
-      }
+      mean_v[i] = _smooth_mean_v[i - _sample_size];
+      if (!ped_interapolated[i]) { sigma_v[i] = _smooth_sigma_v[i - _sample_size]; }
     }
 
     // front mean
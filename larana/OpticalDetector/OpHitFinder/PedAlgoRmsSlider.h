@@ -46,7 +46,7 @@ namespace pmtana {
 
   protected:
     /// Method to compute a pedestal of the input waveform using "nsample" ADC samples from "start" index.
-    bool ComputePedestal(const pmtana::Waveform_t& wf,
+    bool ComputePedestal(pmtana::WaveformView_t wf,
                          pmtana::PedestalMean_t& mean_v,
                          pmtana::PedestalSigma_t& sigma_v);
 
@@ -65,14 +65,15 @@ namespace pmtana {
     int _num_postsample; ///< number of ADCs to sample after the gap
     std::ofstream _csvfile;
 
-    /// Returns the mean of the elements of the vector from start to start+nsample
-    double CalcMean(const std::vector<double>& wf, size_t start, size_t nsample);
-
-    /// Returns the std of the elements of the vector from start to start+nsample
-    double CalcStd(const std::vector<double>& wf,
-                   const double ped_mean,
-                   size_t start,
-                   size_t nsample);
+    /// @{
+    /// @name Scratch buffers, reused across waveforms
+    std::vector<double> _mean_temp_v;    ///< waveform with interpolated gaps
+    std::vector<double> _local_mean_v;   ///< local mean per window (-1 if above threshold)
+    std::vector<double> _local_sigma_v;  ///< local rms per window (-1 if above threshold)
+    std::vector<double> _smooth_mean_v;  ///< smoothed mean per window
+    std::vector<double> _smooth_sigma_v; ///< smoothed rms per window
+    std::vector<bool> _ped_interpolated; ///< whether the tick pedestal was interpolated
+    /// @}
 
     /// Checks the sanity of the estimated pedestal, returns false if not sane
     bool CheckSanity(pmtana::PedestalMean_t& mean_v, pmtana::PedestalSigma_t& sigma_v);
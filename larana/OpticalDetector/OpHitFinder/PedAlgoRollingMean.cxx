@@ -47,7 +47,7 @@ namespace pmtana {
   }
 
   //****************************************************************************
-  bool PedAlgoRollingMean::ComputePedestal(const pmtana::Waveform_t& wf,
+  bool PedAlgoRollingMean::ComputePedestal(pmtana::WaveformView_t wf,
                                            pmtana::PedestalMean_t& mean_v,
                                            pmtana::PedestalSigma_t& sigma_v)
   //****************************************************************************
@@ -122,9 +122,8 @@ namespace pmtana {
 
     unsigned nbins = 1000;
 
-    //////////////////seg faulting...
-    const auto mode_mean = BinnedMaxOccurrence(mean_v, nbins);
-    const auto mode_sigma = BinnedMaxOccurrence(sigma_v, nbins);
+    const auto mode_mean = BinnedMaxOccurrence(mean_v, nbins, _mode_bins);
+    const auto mode_sigma = BinnedMaxOccurrence(sigma_v, nbins, _mode_bins);
 
     //auto mode_mean  = BinnedMaxTH1D(mean_v ,nbins);
     //auto mode_sigma = BinnedMaxTH1D(sigma_v,nbins);
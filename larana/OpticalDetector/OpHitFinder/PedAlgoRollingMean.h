@@ -23,6 +23,7 @@ namespace fhicl {
 #include "larana/OpticalDetector/OpHitFinder/OpticalRecoTypes.h"
 
 #include <string>
+#include <vector>
 
 namespace pmtana {
 
@@ -42,7 +43,7 @@ namespace pmtana {
 
   protected:
     /// Method to compute a pedestal of the input waveform using "nsample" ADC samples from "start" index.
-    bool ComputePedestal(const pmtana::Waveform_t& wf,
+    bool ComputePedestal(pmtana::WaveformView_t wf,
                          pmtana::PedestalMean_t& mean_v,
                          pmtana::PedestalSigma_t& sigma_v);
 
@@ -60,6 +61,9 @@ namespace pmtana {
 
     int _n_presamples;
 
+    /// Scratch space for the mode finding, reused across waveforms.
+    std::vector<size_t> _mode_bins;
+
     //double _random_shift;
   };
 }
@@ -28,7 +28,7 @@ namespace pmtana {
   }
 
   //*********************************************************************
-  bool PedAlgoUB::ComputePedestal(const pmtana::Waveform_t& wf,
+  bool PedAlgoUB::ComputePedestal(pmtana::WaveformView_t wf,
                                   pmtana::PedestalMean_t& mean_v,
                                   pmtana::PedestalSigma_t& sigma_v)
   //*********************************************************************
@@ -57,4 +57,23 @@ namespace pmtana {
     }
   }
 
+  //*********************************************************************
+  bool PedAlgoUB::ComputePedestalModel(pmtana::WaveformView_t wf, pmtana::PedestalModel& model)
+  //*********************************************************************
+  {
+
+    if (wf.size() < _beam_gate_samples) {
+      model.SetConstant(wf.size(), wf.front(), 0); //first sample
+      return true;
+    }
+
+    else {
+
+      _beamgatealgo.Evaluate(wf);
+      model = _beamgatealgo.Model();
+
+      return true;
+    }
+  }
+
 }
@@ -43,10 +43,13 @@ namespace pmtana {
 
   protected:
     /// Method to compute a pedestal of the input waveform using "nsample" ADC samples from "start" index.
-    bool ComputePedestal(const pmtana::Waveform_t& wf,
+    bool ComputePedestal(pmtana::WaveformView_t wf,
                          pmtana::PedestalMean_t& mean_v,
                          pmtana::PedestalSigma_t& sigma_v);
 
+    /// Constant pedestal for short waveforms, the beam gate algorithm result otherwise.
+    bool ComputePedestalModel(pmtana::WaveformView_t wf, pmtana::PedestalModel& model);
+
   private:
     //m    PedAlgoRollingMean _beamgatealgo;
     PedAlgoRmsSlider _beamgatealgo;
@@ -0,0 +1,131 @@
+////////////////////////////////////////////////////////////////////////
+//
+//  PedestalModel source
+//
+////////////////////////////////////////////////////////////////////////
+
+#include "PedestalModel.h"
+#include "OpticalRecoException.h"
+
+namespace pmtana {
+
+  //*******************************************
+  bool PedestalModel::IsConstant() const
+  //*******************************************
+  {
+    return !_dense && _segments.size() == 1 && _segments.front().mean_slope == 0 &&
+           _segments.front().sigma_slope == 0;
+  }
+
+  //*****************************************************************
+  void PedestalModel::SetConstant(size_t n, double mean, double sigma)
+  //*****************************************************************
+  {
+    SetSegmented(n);
+    Segment segment;
+    segment.mean = mean;
+    segment.sigma = sigma;
+    _segments.push_back(segment);
+  }
+
+  //*****************************************
+  void PedestalModel::SetSegmented(size_t n)
+  //*****************************************
+  {
+    _size = n;
+    _dense = false;
+    _expanded = false;
+    _segments.clear();
+  }
+
+  //*********************************************************
+  void PedestalModel::AddSegment(const Segment& segment)
+  //*********************************************************
+  {
+    if (_dense) throw OpticalRecoException("Cannot add a segment to a dense pedestal!");
+    if (_segments.empty() ? segment.begin != 0 : segment.begin <= _segments.back().begin)
+      throw OpticalRecoException("Pedestal segments must be added in order from sample 0!");
+    _segments.push_back(segment);
+    _expanded = false;
+  }
+
+  //*************************************
+  void PedestalModel::SetDense(size_t n)
+  //*************************************
+  {
+    _size = n;
+    _dense = true;
+    _expanded = false;
+    _segments.clear();
+    _mean_v.assign(n, 0);
+    _sigma_v.assign(n, 0);
+  }
+
+  //*********************************
+  void PedestalModel::Expand() const
+  //*********************************
+  {
+    if (_dense || _expanded) return;
+
+    if (_segments.empty() && _size)
+      throw OpticalRecoException("Segmented pedestal has no segment!");
+
+    _mean_v.resize(_size);
+    _sigma_v.resize(_size);
+    for (size_t iseg = 0; iseg < _segments.size(); ++iseg) {
+      Segment const& s = _segments[iseg];
+      size_t const end = (iseg + 1 < _segments.size()) ? _segments[iseg + 1].begin : _size;
+      for (size_t i = s.begin; i < end; ++i) {
+        _mean_v[i] = s.mean + s.mean_slope * double(i - s.begin);
+        _sigma_v[i] = s.sigma + s.sigma_slope * double(i - s.begin);
+      }
+    }
+    _expanded = true;
+  }
+
+  //*************************************************
+  PedestalMeanView_t PedestalModel::MeanView() const
+  //*************************************************
+  {
+    return MeanArray();
+  }
+
+  //***************************************************
+  PedestalSigmaView_t PedestalModel::SigmaView() const
+  //***************************************************
+  {
+    return SigmaArray();
+  }
+
+  //*****************************************************************************
+  PedestalMeanView_t PedestalModel::MeanView(size_t offset, size_t count) const
+  //*****************************************************************************
+  {
+    if (offset + count > _size)
+      throw OpticalRecoException("Requested pedestal range exceeds the waveform!");
+
+    if (_dense || _expanded) return PedestalMeanView_t(_mean_v).subspan(offset, count);
+
+    _range_mean_v.resize(count);
+    for (size_t i = 0; i < count; ++i)
+      _range_mean_v[i] = Mean(offset + i);
+    return _range_mean_v;
+  }
+
+  //*******************************************************
+  const PedestalMean_t& PedestalModel::MeanArray() const
+  //*******************************************************
+  {
+    Expand();
+    return _mean_v;
+  }
+
+  //*********************************************************
+  const PedestalSigma_t& PedestalModel::SigmaArray() const
+  //*********************************************************
+  {
+    Expand();
+    return _sigma_v;
+  }
+
+}
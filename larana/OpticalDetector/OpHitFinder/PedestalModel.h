@@ -0,0 +1,174 @@
+/**
+ * \file PedestalModel.h
+ *
+ * \ingroup PulseReco
+ *
+ * \brief Class definition file of PedestalModel
+ */
+
+/** \addtogroup PulseReco
+
+@{*/
+#ifndef larana_OPTICALDETECTOR_PEDESTALMODEL_H
+#define larana_OPTICALDETECTOR_PEDESTALMODEL_H
+
+#include "OpticalRecoException.h"
+#include "OpticalRecoTypes.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace pmtana {
+
+  /**
+   \class PedestalModel
+   Pedestal mean and standard deviation of a waveform, stored in the most compact of these forms:
+   * dense: one mean and one sigma per ADC sample (arbitrary shapes);
+   * segments: piecewise linear mean and sigma, a single segment for a constant pedestal.
+
+   Values are evaluated on demand per sample with Mean() and Sigma().
+   Algorithms that need dense arrays can get them with MeanView() and SigmaView(): a segmented model
+   is expanded on the first request, and the result is kept until the model is changed.
+   These methods modify internal buffers, so a model must not be shared among threads.
+  */
+  class PedestalModel {
+
+  public:
+    /// A linear piece of the pedestal, from sample `begin` up to the beginning of the next one.
+    struct Segment {
+      size_t begin = 0;
+      double mean = 0;        ///< Pedestal mean at `begin`.
+      double mean_slope = 0;  ///< Mean change per sample.
+      double sigma = 0;       ///< Pedestal standard deviation at `begin`.
+      double sigma_slope = 0; ///< Standard deviation change per sample.
+    };
+
+    /// Number of samples the pedestal is defined for
+    size_t size() const { return _size; }
+
+    /// Whether the pedestal is stored as one value per sample
+    bool IsDense() const { return _dense; }
+
+    /// Whether the pedestal is the same for all samples
+    bool IsConstant() const;
+
+    /// Linear segments of a non-dense pedestal
+    const std::vector<Segment>& Segments() const { return _segments; }
+
+    /// Sets a pedestal constant over `n` samples.
+    void SetConstant(size_t n, double mean, double sigma);
+
+    /// Sets an empty segmented pedestal over `n` samples, to be filled with AddSegment().
+    void SetSegmented(size_t n);
+
+    /// Appends a segment; segments must be added in order, the first starting at sample 0.
+    void AddSegment(const Segment& segment);
+
+    /// Sets a dense pedestal of `n` samples, all zero, to be filled via DenseMean() and DenseSigma().
+    void SetDense(size_t n);
+
+    /// Per-sample mean of a dense pedestal
+    pmtana::PedestalMean_t& DenseMean() { return _mean_v; }
+    const pmtana::PedestalMean_t& DenseMean() const { return _mean_v; }
+
+    /// Per-sample standard deviation of a dense pedestal
+    pmtana::PedestalSigma_t& DenseSigma() { return _sigma_v; }
+    const pmtana::PedestalSigma_t& DenseSigma() const { return _sigma_v; }
+
+    /// Pedestal mean at sample `i` (no range check)
+    double Mean(size_t i) const
+    {
+      if (_dense) return _mean_v[i];
+      Segment const& s = FindSegment(i);
+      return s.mean + s.mean_slope * double(i - s.begin);
+    }
+
+    /// Pedestal standard deviation at sample `i` (no range check)
+    double Sigma(size_t i) const
+    {
+      if (_dense) return _sigma_v[i];
+      Segment const& s = FindSegment(i);
+      return s.sigma + s.sigma_slope * double(i - s.begin);
+    }
+
+    /// Dense array of the pedestal mean (expanded on the first call if needed)
+    pmtana::PedestalMeanView_t MeanView() const;
+
+    /// Dense array of the pedestal standard deviation (expanded on the first call if needed)
+    pmtana::PedestalSigmaView_t SigmaView() const;
+
+    /**
+       Dense array of the pedestal mean of `count` samples from `offset`.
+       For a segmented model only the requested range is expanded, in a buffer which is reused
+       by the next call.
+    */
+    pmtana::PedestalMeanView_t MeanView(size_t offset, size_t count) const;
+
+    /// Dense array of the pedestal mean, the same as MeanView() as a vector
+    const pmtana::PedestalMean_t& MeanArray() const;
+
+    /// Dense array of the pedestal standard deviation, the same as SigmaView() as a vector
+    const pmtana::PedestalSigma_t& SigmaArray() const;
+
+  private:
+    /// Segment including sample `i`
+    const Segment& FindSegment(size_t i) const;
+
+    /// Fills the dense arrays from the segments, if not done yet.
+    void Expand() const;
+
+    size_t _size = 0;
+    bool _dense = true;
+    std::vector<Segment> _segments;
+
+    /// Dense storage, or expansion of the segments when `_expanded`
+    mutable pmtana::PedestalMean_t _mean_v;
+    mutable pmtana::PedestalSigma_t _sigma_v;
+    mutable bool _expanded = false;
+
+    /// Buffer for the expansion of a range of a segmented pedestal
+    mutable pmtana::PedestalMean_t _range_mean_v;
+  };
+
+  /**
+     Pedestal access with the PedestalModel interface on dense arrays owned elsewhere,
+     to share code between algorithms working on either.
+  */
+  class PedestalArrays {
+
+  public:
+    PedestalArrays(pmtana::PedestalMeanView_t mean_v, pmtana::PedestalSigmaView_t sigma_v)
+      : _mean_v(mean_v), _sigma_v(sigma_v)
+    {}
+
+    size_t size() const { return _mean_v.size(); }
+    double Mean(size_t i) const { return _mean_v[i]; }
+    double Sigma(size_t i) const { return _sigma_v[i]; }
+    pmtana::PedestalMeanView_t MeanView() const { return _mean_v; }
+    pmtana::PedestalSigmaView_t SigmaView() const { return _sigma_v; }
+    pmtana::PedestalMeanView_t MeanView(size_t offset, size_t count) const
+    {
+      return _mean_v.subspan(offset, count);
+    }
+
+  private:
+    pmtana::PedestalMeanView_t _mean_v;
+    pmtana::PedestalSigmaView_t _sigma_v;
+  };
+
+  //----------------------------------------------------------------------------
+  inline const PedestalModel::Segment& PedestalModel::FindSegment(size_t i) const
+  {
+    if (_segments.empty()) throw OpticalRecoException("Segmented pedestal has no segment!");
+
+    // most pedestals have very few segments: a linear search is fastest
+    size_t iseg = _segments.size() - 1;
+    while (iseg > 0 && _segments[iseg].begin > i)
+      --iseg;
+    return _segments[iseg];
+  }
+
+}
+#endif
+
+/** @} */ // end of doxygen group
@@ -9,6 +9,8 @@
 #include "larana/OpticalDetector/OpHitFinder/PMTPedestalBase.h"
 #include "larana/OpticalDetector/OpHitFinder/PMTPulseRecoBase.h"
 
+#include <algorithm>
+#include <limits>
 #include <sstream>
 
 namespace pmtana {
@@ -27,6 +29,11 @@ namespace pmtana {
     if (!algo) throw OpticalRecoException("Invalid PulseReco algorithm!");
 
     _reco_algo_v.push_back(std::make_pair(algo, ped_algo));
+
+    if (_collect_stats) {
+      algo->EnableStats(true);
+      if (ped_algo) ped_algo->EnableStats(true);
+    }
   }
 
   //**************************************************************
@@ -35,19 +42,147 @@ namespace pmtana {
   {
     if (!algo) throw OpticalRecoException("Invalid Pedestal algorithm!");
     _ped_algo = algo;
+
+    if (_collect_stats) _ped_algo->EnableStats(true);
+  }
+
+  //**************************************************
+  void PulseRecoManager::EnableStats(bool enable)
+  //**************************************************
+  {
+    _collect_stats = enable;
+
+    if (_ped_algo) _ped_algo->EnableStats(enable);
+    for (auto& algo_pair : _reco_algo_v) {
+      algo_pair.first->EnableStats(enable);
+      if (algo_pair.second) algo_pair.second->EnableStats(enable);
+    }
+  }
+
+  //**************************************************
+  PulseRecoStats PulseRecoManager::Stats() const
+  //**************************************************
+  {
+    PulseRecoStats stats;
+    stats.n_waveforms = _n_waveforms;
+    stats.n_skipped = _n_skipped;
+
+    // each pedestal algorithm is reported once, even if shared by several pulse algorithms
+    std::vector<PMTPedestalBase const*> ped_algos;
+    auto add_pedestal = [&stats, &ped_algos](PMTPedestalBase const* ped_algo) {
+      if (!ped_algo) return;
+      if (std::find(ped_algos.begin(), ped_algos.end(), ped_algo) != ped_algos.end()) return;
+      ped_algos.push_back(ped_algo);
+      stats.pedestal.push_back(ped_algo->Stats());
+    };
+
+    add_pedestal(_ped_algo);
+    for (auto const& algo_pair : _reco_algo_v) {
+      add_pedestal(algo_pair.second);
+      stats.pulse.push_back(algo_pair.first->Stats());
+    }
+
+    return stats;
+  }
+
+  //**************************************************
+  void PulseRecoManager::ResetStats()
+  //**************************************************
+  {
+    _n_waveforms = _n_skipped = 0;
+
+    if (_ped_algo) _ped_algo->ResetStats();
+    for (auto& algo_pair : _reco_algo_v) {
+      algo_pair.first->ResetStats();
+      if (algo_pair.second) algo_pair.second->ResetStats();
+    }
+  }
+
+  //*************************************************************************
+  bool PulseRecoManager::Reconstruct(pmtana::WaveformView_t wf, int channel) const
+  //*************************************************************************
+  {
+    if (_ped_algo) _ped_algo->SetChannel(channel);
+    for (auto const& algo_pair : _reco_algo_v)
+      if (algo_pair.second) algo_pair.second->SetChannel(channel);
+
+    return Reconstruct(wf);
+  }
+
+  //*********************************
+  void PulseRecoManager::NewEvent()
+  //*********************************
+  {
+    if (_ped_algo) _ped_algo->NewEvent();
+    for (auto& algo_pair : _reco_algo_v)
+      if (algo_pair.second) algo_pair.second->NewEvent();
   }
 
   //**********************************************************************
-  bool PulseRecoManager::Reconstruct(const pmtana::Waveform_t& wf) const
+  bool PulseRecoManager::IsQuiet(pmtana::WaveformView_t wf) const
+  //**********************************************************************
+  {
+    if (_reco_algo_v.empty() || wf.empty()) return false;
+
+    double min_excursion = std::numeric_limits<double>::max();
+    for (auto const& algo_pair : _reco_algo_v)
+      min_excursion = std::min(min_excursion, algo_pair.first->MinPulseExcursion());
+    if (min_excursion <= 0.) return false;
+
+    // the test below is valid only if the pedestal is within the range of the samples
+    if (_ped_algo && !_ped_algo->PedestalWithinSampleRange()) return false;
+    for (auto const& algo_pair : _reco_algo_v)
+      if (algo_pair.second && !algo_pair.second->PedestalWithinSampleRange()) return false;
+
+    // branch-free scan, which the compiler can vectorize
+    short const* adc = wf.data();
+    short wf_min = adc[0];
+    short wf_max = adc[0];
+    for (size_t i = 1; i < wf.size(); ++i) {
+      wf_min = std::min(wf_min, adc[i]);
+      wf_max = std::max(wf_max, adc[i]);
+    }
+
+    // with the pedestal within [ wf_min, wf_max ], no sample can be farther from it than this
+    return (double(wf_max) - double(wf_min)) < min_excursion;
+  }
+
+  //*************************************************************************
+  bool PulseRecoManager::EvaluatePedestal(PMTPedestalBase* ped_algo,
+                                          pmtana::WaveformView_t wf) const
+  //*************************************************************************
+  {
+    // there are only a few pedestal algorithms: a linear search is fastest
+    for (auto const& evaluated : _evaluated_ped_v)
+      if (evaluated.first == ped_algo) return evaluated.second;
+
+    bool const status = ped_algo->Evaluate(wf);
+    _evaluated_ped_v.emplace_back(ped_algo, status);
+    return status;
+  }
+
+  //**********************************************************************
+  bool PulseRecoManager::Reconstruct(pmtana::WaveformView_t wf) const
   //**********************************************************************
   {
     if (_reco_algo_v.empty() && !_ped_algo)
 
       throw OpticalRecoException("No Pulse/Pedestal reconstruction to run!");
 
+    ++_n_waveforms;
+
+    if (_skip_quiet && IsQuiet(wf)) {
+      ++_n_skipped;
+      for (auto& algo_pair : _reco_algo_v)
+        algo_pair.first->Reset();
+      return true;
+    }
+
+    _evaluated_ped_v.clear();
+
     bool ped_status = true;
 
-    if (_ped_algo) ped_status = _ped_algo->Evaluate(wf);
+    if (_ped_algo) ped_status = EvaluatePedestal(_ped_algo, wf);
 
     bool pulse_reco_status = ped_status;
 
@@ -58,10 +193,10 @@ namespace pmtana {
 
       if (ped_algo) {
 
-        ped_status = ped_status && ped_algo->Evaluate(wf);
+        ped_status = ped_status && EvaluatePedestal(ped_algo, wf);
 
         pulse_reco_status = (ped_status && pulse_reco_status &&
-                             pulse_algo->Reconstruct(wf, ped_algo->Mean(), ped_algo->Sigma()));
+                             pulse_algo->Reconstruct(wf, ped_algo->Model()));
       }
       else {
 
@@ -72,7 +207,7 @@ namespace pmtana {
         }
 
         pulse_reco_status =
-          (pulse_reco_status && pulse_algo->Reconstruct(wf, _ped_algo->Mean(), _ped_algo->Sigma()));
+          (pulse_reco_status && pulse_algo->Reconstruct(wf, _ped_algo->Model()));
       }
     }
 
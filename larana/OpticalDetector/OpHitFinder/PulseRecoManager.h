@@ -16,6 +16,7 @@
 #define PULSERECOMANAGER_H
 
 #include "larana/OpticalDetector/OpHitFinder/OpticalRecoTypes.h"
+#include "larana/OpticalDetector/OpHitFinder/PulseRecoStats.h"
 
 #include <vector>
 
@@ -29,6 +30,8 @@ namespace pmtana {
    A manager class of pulse reconstruction which acts as an analysis unit (inherits from ana_base).
    This class executes various pulse reconstruction algorithm which inherits from PMTPulseRecoBase
    Refer to analyze() function implementation to check how a pulse reconstruction algorithm is called.
+   Each pedestal algorithm is evaluated at most once per waveform, and its result is shared by all
+   the pulse algorithms using it, so several pulse algorithms can run on the same pedestal cheaply.
   */
   class PulseRecoManager {
 
@@ -37,7 +40,13 @@ namespace pmtana {
     PulseRecoManager();
 
     /// Implementation of ana_base::analyze method
-    bool Reconstruct(const pmtana::Waveform_t&) const;
+    bool Reconstruct(pmtana::WaveformView_t) const;
+
+    /// Same as above, for a waveform from `channel` (used by algorithms with per-channel state)
+    bool Reconstruct(pmtana::WaveformView_t, int channel) const;
+
+    /// Notifies all the pedestal algorithms of the start of a new event
+    void NewEvent();
 
     /// A method to set pulse reconstruction algorithm
     void AddRecoAlgo(pmtana::PMTPulseRecoBase* algo, PMTPedestalBase* ped_algo = nullptr);
@@ -45,12 +54,63 @@ namespace pmtana {
     /// A method to set a choice of pedestal estimation method
     void SetDefaultPedAlgo(pmtana::PMTPedestalBase* algo);
 
+    /**
+      Enables the skipping of quiet waveforms. Before any pedestal estimation, the range of the
+      waveform samples is compared to the smallest MinPulseExcursion() of the pulse algorithms:
+      if it is narrower, no algorithm can find a pulse, their pulses are cleared and the waveform
+      is not processed further (the pedestal algorithms are not run either).
+      This assumes the pedestal within the range of the samples: waveforms are never skipped
+      if any of the pedestal algorithms does not guarantee it (PedestalWithinSampleRange()).
+    */
+    void SetSkipQuietWaveforms(bool skip) { _skip_quiet = skip; }
+
+    /// Whether quiet waveforms are skipped
+    bool SkipQuietWaveforms() const { return _skip_quiet; }
+
+    /// Number of waveforms passed to Reconstruct()
+    size_t NWaveforms() const { return _n_waveforms; }
+
+    /// Number of waveforms skipped as quiet
+    size_t NSkippedWaveforms() const { return _n_skipped; }
+
+    /**
+      Enables the collection of execution statistics (time, waveforms, samples and pulses) by all
+      the algorithms, including the ones added later. When disabled, the overhead is one check
+      per algorithm call.
+    */
+    void EnableStats(bool enable);
+
+    /// Statistics of the manager and of its algorithms
+    pmtana::PulseRecoStats Stats() const;
+
+    /// Clears the statistics of the manager and of its algorithms
+    void ResetStats();
+
   private:
+    /// Whether the waveform is too quiet for any of the pulse algorithms to find a pulse
+    bool IsQuiet(pmtana::WaveformView_t wf) const;
+
+    /// Evaluates the pedestal of the waveform, unless already done for the current waveform
+    bool EvaluatePedestal(pmtana::PMTPedestalBase* ped_algo, pmtana::WaveformView_t wf) const;
+
     /// pulse reconstruction algorithm pointer
     std::vector<std::pair<pmtana::PMTPulseRecoBase*, pmtana::PMTPedestalBase*>> _reco_algo_v;
 
     /// ped_estimator object
     PMTPedestalBase* _ped_algo;
+
+    /// Whether quiet waveforms are skipped
+    bool _skip_quiet = false;
+
+    /// Whether the algorithms collect statistics
+    bool _collect_stats = false;
+
+    /// Pedestal algorithms evaluated on the current waveform, with their status
+    mutable std::vector<std::pair<pmtana::PMTPedestalBase*, bool>> _evaluated_ped_v;
+
+    /// Waveform counters, updated by the (logically const) reconstruction
+    mutable size_t _n_waveforms = 0;
+    mutable size_t _n_skipped = 0;
   };
 }
 #endif
@@ -0,0 +1,76 @@
+////////////////////////////////////////////////////////////////////////
+//
+//  PulseRecoStats source
+//
+////////////////////////////////////////////////////////////////////////
+
+#include "PulseRecoStats.h"
+#include "OpticalRecoException.h"
+
+#include <iomanip>
+#include <ostream>
+
+namespace pmtana {
+
+  //*********************************************
+  void AlgoStats::Merge(const AlgoStats& other)
+  //*********************************************
+  {
+    if (name != other.name)
+      throw OpticalRecoException("Cannot merge statistics of algorithms '" + name + "' and '" +
+                                 other.name + "'!");
+    n_waveforms += other.n_waveforms;
+    n_samples += other.n_samples;
+    time += other.time;
+    n_pulses += other.n_pulses;
+    n_rejected += other.n_rejected;
+    n_risetime += other.n_risetime;
+    risetime_time += other.risetime_time;
+  }
+
+  //*******************************************************
+  void PulseRecoStats::Merge(const PulseRecoStats& other)
+  //*******************************************************
+  {
+    if (pedestal.size() != other.pedestal.size() || pulse.size() != other.pulse.size())
+      throw OpticalRecoException("Cannot merge statistics of different algorithm sets!");
+
+    n_waveforms += other.n_waveforms;
+    n_skipped += other.n_skipped;
+    for (size_t i = 0; i < pedestal.size(); ++i)
+      pedestal[i].Merge(other.pedestal[i]);
+    for (size_t i = 0; i < pulse.size(); ++i)
+      pulse[i].Merge(other.pulse[i]);
+  }
+
+  //*************************************************************************
+  std::ostream& operator<<(std::ostream& out, const PulseRecoStats& stats)
+  //*************************************************************************
+  {
+    out << "Waveforms: " << stats.n_waveforms << " (" << stats.n_skipped << " skipped as quiet)";
+
+    auto const print = [&out](const char* stage, const AlgoStats& algo) {
+      out << "\n  " << std::left << std::setw(9) << stage << std::setw(24) << algo.name
+          << std::right << std::setw(10) << algo.n_waveforms << " waveforms " << std::setw(12)
+          << algo.n_samples << " samples " << std::fixed << std::setprecision(3) << std::setw(10)
+          << algo.time << " s";
+      if (algo.n_samples && algo.time > 0.)
+        out << std::setprecision(1) << std::setw(8) << (algo.n_samples / algo.time / 1e6)
+            << " Msamples/s";
+      out << std::defaultfloat;
+    };
+
+    for (auto const& algo : stats.pedestal)
+      print("pedestal", algo);
+
+    for (auto const& algo : stats.pulse) {
+      print("pulse", algo);
+      out << "\n  " << std::setw(33) << "" << algo.n_pulses << " pulses, " << algo.n_rejected
+          << " rejected; rise time: " << algo.n_risetime << " calls, " << std::fixed
+          << std::setprecision(3) << algo.risetime_time << " s" << std::defaultfloat;
+    }
+
+    return out;
+  }
+
+}
@@ -0,0 +1,72 @@
+/**
+ * \file PulseRecoStats.h
+ *
+ * \ingroup PulseReco
+ *
+ * \brief Class definition file of the pulse reconstruction statistics
+ */
+
+/** \addtogroup PulseReco
+
+@{*/
+#ifndef larana_OPTICALDETECTOR_PULSERECOSTATS_H
+#define larana_OPTICALDETECTOR_PULSERECOSTATS_H
+
+#include <chrono>
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace pmtana {
+
+  /// Clock used to time the reconstruction stages
+  typedef std::chrono::steady_clock StatsClock_t;
+
+  /// Seconds elapsed since `start`
+  inline double SecondsSince(StatsClock_t::time_point start)
+  {
+    return std::chrono::duration<double>(StatsClock_t::now() - start).count();
+  }
+
+  /**
+   \struct AlgoStats
+   Execution counters of a pedestal or pulse reconstruction algorithm.
+   The pulse and rise time counters are only filled for pulse algorithms.
+  */
+  struct AlgoStats {
+    std::string name;
+    std::size_t n_waveforms = 0;  ///< Waveforms processed.
+    std::size_t n_samples = 0;    ///< Samples in the processed waveforms.
+    double time = 0.;             ///< Wall time in the algorithm [s], rise time included.
+    std::size_t n_pulses = 0;     ///< Pulses found.
+    std::size_t n_rejected = 0;   ///< Pulse candidates rejected (width or threshold).
+    std::size_t n_risetime = 0;   ///< Rise time calculations.
+    double risetime_time = 0.;    ///< Wall time in the rise time calculations [s].
+
+    /// Adds the counters of `other`, which must be from the same algorithm.
+    void Merge(const AlgoStats& other);
+  };
+
+  /**
+   \struct PulseRecoStats
+   Counters of a PulseRecoManager and of the algorithms it runs:
+   each distinct pedestal algorithm, the default one first, and each pulse algorithm.
+  */
+  struct PulseRecoStats {
+    std::size_t n_waveforms = 0; ///< Waveforms passed to the manager.
+    std::size_t n_skipped = 0;   ///< Waveforms skipped as quiet.
+    std::vector<AlgoStats> pedestal;
+    std::vector<AlgoStats> pulse;
+
+    /// Adds the counters of `other`, from a manager with the same algorithms (e.g. another thread).
+    void Merge(const PulseRecoStats& other);
+  };
+
+  /// Prints a summary table of the statistics.
+  std::ostream& operator<<(std::ostream& out, const PulseRecoStats& stats);
+
+}
+#endif
+
+/** @} */ // end of doxygen group
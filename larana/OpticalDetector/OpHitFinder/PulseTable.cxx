@@ -0,0 +1,87 @@
+////////////////////////////////////////////////////////////////////////
+//
+//  PulseTable source
+//
+////////////////////////////////////////////////////////////////////////
+
+#include "PulseTable.h"
+
+namespace pmtana {
+
+  //*************************
+  void PulseTable::clear()
+  //*************************
+  {
+    channel.clear();
+    time_stamp.clear();
+    t_start.clear();
+    t_max.clear();
+    t_end.clear();
+    t_rise.clear();
+    peak.clear();
+    area.clear();
+    ped_mean.clear();
+    ped_sigma.clear();
+    t_cfdcross.clear();
+  }
+
+  //*********************************
+  void PulseTable::reserve(size_t n)
+  //*********************************
+  {
+    channel.reserve(n);
+    time_stamp.reserve(n);
+    t_start.reserve(n);
+    t_max.reserve(n);
+    t_end.reserve(n);
+    t_rise.reserve(n);
+    peak.reserve(n);
+    area.reserve(n);
+    ped_mean.reserve(n);
+    ped_sigma.reserve(n);
+    t_cfdcross.reserve(n);
+  }
+
+  //*****************************************************************************
+  void PulseTable::push_back(int ch, double timeStamp, const pulse_param& pulse)
+  //*****************************************************************************
+  {
+    channel.push_back(ch);
+    time_stamp.push_back(timeStamp);
+    t_start.push_back(pulse.t_start);
+    t_max.push_back(pulse.t_max);
+    t_end.push_back(pulse.t_end);
+    t_rise.push_back(pulse.t_rise);
+    peak.push_back(pulse.peak);
+    area.push_back(pulse.area);
+    ped_mean.push_back(pulse.ped_mean);
+    ped_sigma.push_back(pulse.ped_sigma);
+    t_cfdcross.push_back(pulse.t_cfdcross);
+  }
+
+  //*******************************************************************************
+  void PulseTable::append(int ch, double timeStamp, const pulse_param_array& pulses)
+  //*******************************************************************************
+  {
+    for (auto const& pulse : pulses)
+      push_back(ch, timeStamp, pulse);
+  }
+
+  //**********************************************
+  pulse_param PulseTable::Pulse(size_t i) const
+  //**********************************************
+  {
+    pulse_param pulse;
+    pulse.t_start = t_start[i];
+    pulse.t_max = t_max[i];
+    pulse.t_end = t_end[i];
+    pulse.t_rise = t_rise[i];
+    pulse.peak = peak[i];
+    pulse.area = area[i];
+    pulse.ped_mean = ped_mean[i];
+    pulse.ped_sigma = ped_sigma[i];
+    pulse.t_cfdcross = t_cfdcross[i];
+    return pulse;
+  }
+
+}
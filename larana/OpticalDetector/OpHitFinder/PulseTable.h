@@ -0,0 +1,71 @@
+/**
+ * \file PulseTable.h
+ *
+ * \ingroup PulseReco
+ *
+ * \brief Class definition file of PulseTable
+ */
+
+/** \addtogroup PulseReco
+
+@{*/
+#ifndef larana_OPTICALDETECTOR_PULSETABLE_H
+#define larana_OPTICALDETECTOR_PULSETABLE_H
+
+#include "PMTPulseRecoBase.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace pmtana {
+
+  /**
+   \class PulseTable
+   Pulses reconstructed from a collection of waveforms, stored by column: the `i`-th pulse is
+   described by the `i`-th element of each of the vectors. Pulses of the same waveform are
+   contiguous, in the order they were found, and they share channel and time stamp.
+
+   A table can be cleared and refilled without releasing its memory, so that reusing it for
+   every event avoids allocations once the capacity settles.
+  */
+  class PulseTable {
+
+  public:
+    std::vector<int> channel;        ///< Channel of the waveform.
+    std::vector<double> time_stamp;  ///< Time stamp of the waveform.
+    std::vector<double> t_start;     ///< Tick of the start of the pulse in the waveform.
+    std::vector<double> t_max;       ///< Tick of the pulse maximum.
+    std::vector<double> t_end;       ///< Tick of the end of the pulse.
+    std::vector<double> t_rise;      ///< Rise time [ticks].
+    std::vector<double> peak;        ///< Peak amplitude above pedestal.
+    std::vector<double> area;        ///< Area above pedestal.
+    std::vector<double> ped_mean;    ///< Pedestal mean at the pulse.
+    std::vector<double> ped_sigma;   ///< Pedestal standard deviation at the pulse.
+    std::vector<double> t_cfdcross;  ///< CFD crossing tick (AlgoCFD only).
+
+    /// Number of pulses
+    size_t size() const { return t_start.size(); }
+
+    /// Whether there is no pulse
+    bool empty() const { return t_start.empty(); }
+
+    /// Removes all pulses, keeping the allocated memory
+    void clear();
+
+    /// Allocates memory for `n` pulses in all columns
+    void reserve(size_t n);
+
+    /// Appends a pulse from a waveform on `ch` with time stamp `timeStamp`
+    void push_back(int ch, double timeStamp, const pmtana::pulse_param& pulse);
+
+    /// Appends all the pulses of an algorithm for a waveform on `ch` with time stamp `timeStamp`
+    void append(int ch, double timeStamp, const pmtana::pulse_param_array& pulses);
+
+    /// Pulse `i` as a pulse_param object
+    pmtana::pulse_param Pulse(size_t i) const;
+  };
+
+}
+#endif
+
+/** @} */ // end of doxygen group
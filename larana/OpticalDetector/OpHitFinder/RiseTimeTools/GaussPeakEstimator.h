@@ -0,0 +1,133 @@
+/**
+ * \file GaussPeakEstimator.h
+ *
+ * \brief Closed-form estimate of the position of a Gaussian-shaped peak
+ *
+ * The logarithm of a Gaussian is a parabola, so the peak position can be
+ * obtained from a weighted least-squares parabola fit to the logarithm of the
+ * samples around a local maximum (Caruana's method, with Guo's weights).
+ * With a single sample on each side of the maximum this is the classic
+ * three-point Gaussian interpolation.
+ *
+ * The functions here operate directly on the waveform and pedestal views and
+ * use no heap memory or global state, so they can be used concurrently.
+ */
+
+#ifndef GAUSSPEAKESTIMATOR_H
+#define GAUSSPEAKESTIMATOR_H
+
+#include "larana/OpticalDetector/OpHitFinder/OpticalRecoTypes.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+namespace pmtana {
+
+  /// Pedestal-subtracted sample `i`, positive for a signal of the given polarity.
+  inline double PulseSample(WaveformView_t wf,
+                            PedestalMeanView_t ped,
+                            std::size_t i,
+                            bool positive)
+  {
+    return positive ? ((double)wf[i]) - ped[i] : ped[i] - ((double)wf[i]);
+  }
+
+  /**
+   * @brief Returns the tick of the first local maximum at least `threshold` high.
+   * @param found (output) whether such a maximum was found
+   *
+   * Same search as `RiseTimeGaussFit::findFirstMax()`, on the
+   * pedestal-subtracted pulse; if there is no such maximum, `0` is returned.
+   */
+  inline std::size_t FirstLocalMax(WaveformView_t wf,
+                                   PedestalMeanView_t ped,
+                                   bool positive,
+                                   double threshold,
+                                   bool& found)
+  {
+    found = false;
+    std::size_t const n = std::min(wf.size(), ped.size());
+    if (n == 0) return 0;
+
+    double max = PulseSample(wf, ped, 0, positive);
+    for (std::size_t i = 1; i < n; ++i) {
+      double const value = PulseSample(wf, ped, i, positive);
+      if (value >= max || max < threshold)
+        max = value;
+      else {
+        found = true;
+        return i - 1;
+      }
+    }
+    return 0;
+  }
+
+  /**
+   * @brief Estimates the position of a Gaussian peak around sample `imax`.
+   * @param nbins number of samples used on each side of `imax`
+   * @return the peak position in ticks, or NaN if the samples are not peaked
+   *
+   * Only samples in `[imax - nbins, imax + nbins]` with a positive
+   * (pedestal-subtracted) value contribute, each with weight `y^2`, which
+   * accounts for the error on `log(y)` under a constant noise. At least three
+   * samples are needed, and the fitted parabola must be concave.
+   */
+  inline double GaussPeakPosition(WaveformView_t wf,
+                                  PedestalMeanView_t ped,
+                                  bool positive,
+                                  std::size_t imax,
+                                  std::size_t nbins)
+  {
+    constexpr double NaN = std::numeric_limits<double>::quiet_NaN();
+
+    std::size_t const n = std::min(wf.size(), ped.size());
+    if (imax >= n) return NaN;
+    std::size_t const first = (imax > nbins) ? imax - nbins : 0;
+    std::size_t const last = std::min(imax + nbins, n - 1);
+
+    // moments of the weights (S) and of the weighted logarithms (T);
+    // positions are relative to imax to keep the system well conditioned
+    double S0 = 0., S1 = 0., S2 = 0., S3 = 0., S4 = 0.;
+    double T0 = 0., T1 = 0., T2 = 0.;
+    unsigned int npoints = 0;
+    for (std::size_t i = first; i <= last; ++i) {
+      double const y = PulseSample(wf, ped, i, positive);
+      if (!(y > 0.)) continue;
+      double const x = double(i) - double(imax);
+      double const x2 = x * x;
+      double const w = y * y;
+      double const l = std::log(y);
+      S0 += w;
+      S1 += w * x;
+      S2 += w * x2;
+      S3 += w * x2 * x;
+      S4 += w * x2 * x2;
+      T0 += w * l;
+      T1 += w * l * x;
+      T2 += w * l * x2;
+      ++npoints;
+    }
+    if (npoints < 3) return NaN;
+
+    // normal equations for log(y) = a + b x + c x^2, solved by Cramer's rule;
+    // only b and c are needed for the vertex
+    double const det =
+      S0 * (S2 * S4 - S3 * S3) - S1 * (S1 * S4 - S3 * S2) + S2 * (S1 * S3 - S2 * S2);
+    if (det == 0.) return NaN;
+    double const detB =
+      S0 * (T1 * S4 - S3 * T2) - T0 * (S1 * S4 - S3 * S2) + S2 * (S1 * T2 - T1 * S2);
+    double const detC =
+      S0 * (S2 * T2 - T1 * S3) - S1 * (S1 * T2 - T1 * S2) + T0 * (S1 * S3 - S2 * S2);
+
+    double const b = detB / det;
+    double const c = detC / det;
+    if (!(c < 0.)) return NaN;
+
+    return double(imax) - b / (2. * c);
+  }
+
+}
+
+#endif
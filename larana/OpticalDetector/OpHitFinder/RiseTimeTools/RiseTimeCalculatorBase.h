@@ -20,10 +20,13 @@ namespace pmtana {
     virtual ~RiseTimeCalculatorBase() noexcept = default;
 
     // Method to calculate the OpFlash t0
-    virtual double RiseTime(const pmtana::Waveform_t& wf_pulse,
-                            const pmtana::PedestalMean_t& ped_pulse,
+    virtual double RiseTime(pmtana::WaveformView_t wf_pulse,
+                            pmtana::PedestalMeanView_t ped_pulse,
                             bool _positive) const = 0;
 
+    // Whether RiseTime() can be called concurrently on different threads
+    virtual bool ThreadSafe() const { return false; }
+
   private:
   };
 }
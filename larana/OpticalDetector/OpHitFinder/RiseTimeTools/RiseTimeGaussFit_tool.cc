@@ -37,9 +37,12 @@ namespace pmtana {
     explicit RiseTimeGaussFit(art::ToolConfigTable<Config> const& config);
 
     // Method to calculate the OpFlash t0
-    double RiseTime(const pmtana::Waveform_t& wf_pulse,
-                    const pmtana::PedestalMean_t& ped_pulse,
+    double RiseTime(pmtana::WaveformView_t wf_pulse,
+                    pmtana::PedestalMeanView_t ped_pulse,
                     bool _positive) const override;
+
+    // The fit uses ROOT objects with fixed names ("aux", "f"), registered globally
+    bool ThreadSafe() const override { return false; }
     // Method to fit the first local max of the wvf above fixed threshold
     std::size_t findFirstMax(const std::vector<double>& arr, double threshold) const;
 
@@ -57,13 +60,13 @@ namespace pmtana {
     , fNbins{config().Nbins()}
   {}
 
-  double RiseTimeGaussFit::RiseTime(const pmtana::Waveform_t& wf_pulse,
-                                    const pmtana::PedestalMean_t& ped_pulse,
+  double RiseTimeGaussFit::RiseTime(pmtana::WaveformView_t wf_pulse,
+                                    pmtana::PedestalMeanView_t ped_pulse,
                                     bool _positive) const
   {
 
     // Pedestal-subtracted pulse
-    std::vector<double> wf_aux(ped_pulse);
+    std::vector<double> wf_aux(ped_pulse.begin(), ped_pulse.end());
     if (_positive) {
       for (size_t ix = 0; ix < wf_aux.size(); ix++) {
         wf_aux[ix] = ((double)wf_pulse[ix]) - wf_aux[ix];
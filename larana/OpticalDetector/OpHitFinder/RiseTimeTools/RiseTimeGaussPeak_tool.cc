@@ -0,0 +1,83 @@
+/**
+ * \file RiseTimeGaussPeak_tool.cc
+ *
+ * \brief Rise time computed as the center of the first local maximum,
+ * like RiseTimeGaussFit, but estimating the Gaussian peak position with a
+ * closed-form fit to the logarithm of the samples instead of a ROOT fit.
+ * The tool allocates no memory and keeps no state, so it is thread safe.
+ * Fixed min threshold required set in the fhicl file
+ */
+
+#include "art/Utilities/ToolConfigTable.h"
+#include "art/Utilities/ToolMacros.h"
+#include "fhiclcpp/types/Atom.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+#include "GaussPeakEstimator.h"
+#include "RiseTimeCalculatorBase.h"
+
+#include <cmath>
+
+namespace pmtana {
+
+  class RiseTimeGaussPeak : RiseTimeCalculatorBase {
+
+  public:
+    //Configuration parameters
+    struct Config {
+
+      fhicl::Atom<double> MinAmp{
+        fhicl::Name("MinAmp"),
+        fhicl::Comment("minimal amplitude of the peak to be considered a local maximum")};
+      fhicl::Atom<unsigned int> Nbins{
+        fhicl::Name("Nbins"),
+        fhicl::Comment("samples used in the peak fit on each side of the maximum")};
+      fhicl::Atom<double> Tolerance{
+        fhicl::Name("Tolerance"),
+        fhicl::Comment("fits farther than this from the maximum fall back to the maximum")};
+    };
+
+    // Default constructor
+    explicit RiseTimeGaussPeak(art::ToolConfigTable<Config> const& config);
+
+    // Method to calculate the OpFlash t0
+    double RiseTime(pmtana::WaveformView_t wf_pulse,
+                    pmtana::PedestalMeanView_t ped_pulse,
+                    bool _positive) const override;
+
+    // No shared state
+    bool ThreadSafe() const override { return true; }
+
+  private:
+    double fMinAmp;
+    double fTolerance;
+    unsigned int fNbins;
+  };
+
+  RiseTimeGaussPeak::RiseTimeGaussPeak(art::ToolConfigTable<Config> const& config)
+    : fMinAmp{config().MinAmp()}, fTolerance{config().Tolerance()}, fNbins{config().Nbins()}
+  {}
+
+  double RiseTimeGaussPeak::RiseTime(pmtana::WaveformView_t wf_pulse,
+                                     pmtana::PedestalMeanView_t ped_pulse,
+                                     bool _positive) const
+  {
+    // Find first local maximum
+    bool found = false;
+    std::size_t const first_max = FirstLocalMax(wf_pulse, ped_pulse, _positive, fMinAmp, found);
+    if (!found)
+      mf::LogInfo("RiseTimeGaussPeak") << "No local max found above fixed threshold: " << fMinAmp;
+
+    double const t_fit = GaussPeakPosition(wf_pulse, ped_pulse, _positive, first_max, fNbins);
+
+    //check fit is close in distance to the original max, use max peak as time otherwise
+    // (NaN from a failed fit also fails the check)
+    if (std::abs(t_fit - first_max) < fTolerance) return t_fit;
+
+    mf::LogInfo("RiseTimeGaussPeak") << "No good fit found, keeping 1st max bin instead";
+    return first_max;
+  }
+
+}
+
+DEFINE_ART_CLASS_TOOL(pmtana::RiseTimeGaussPeak)
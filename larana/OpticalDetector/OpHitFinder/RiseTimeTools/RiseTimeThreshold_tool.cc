@@ -29,10 +29,13 @@ namespace pmtana {
     explicit RiseTimeThreshold(art::ToolConfigTable<Config> const& config);
 
     // Method to calculate the OpFlash t0
-    double RiseTime(const pmtana::Waveform_t& wf_pulse,
-                    const pmtana::PedestalMean_t& ped_pulse,
+    double RiseTime(pmtana::WaveformView_t wf_pulse,
+                    pmtana::PedestalMeanView_t ped_pulse,
                     bool _positive) const override;
 
+    // No shared state
+    bool ThreadSafe() const override { return true; }
+
   private:
     double fPeakRatio;
   };
@@ -41,13 +44,13 @@ namespace pmtana {
     : fPeakRatio{config().PeakRatio()}
   {}
 
-  double RiseTimeThreshold::RiseTime(const pmtana::Waveform_t& wf_pulse,
-                                     const pmtana::PedestalMean_t& ped_pulse,
+  double RiseTimeThreshold::RiseTime(pmtana::WaveformView_t wf_pulse,
+                                     pmtana::PedestalMeanView_t ped_pulse,
                                      bool _positive) const
   {
 
     // Pedestal-subtracted pulse
-    std::vector<double> wf_aux(ped_pulse);
+    std::vector<double> wf_aux(ped_pulse.begin(), ped_pulse.end());
     if (_positive) {
       for (size_t ix = 0; ix < wf_aux.size(); ix++) {
         wf_aux[ix] = ((double)wf_pulse[ix]) - wf_aux[ix];
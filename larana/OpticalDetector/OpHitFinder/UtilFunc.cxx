@@ -4,13 +4,61 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <numeric>
+#include <type_traits>
+
+namespace {
+
+  // Running sum engine behind pmtana::sliding_mean_std().
+  // Integer samples are summed exactly; floating point samples are summed
+  // relative to the first sample to limit the cancellation in the variance.
+  template <typename T>
+  void sliding_mean_std_impl(pmtana::ArrayView<T> wf,
+                             size_t nsample,
+                             std::vector<double>& mean_v,
+                             std::vector<double>& sigma_v)
+  {
+    if (!nsample || nsample > wf.size())
+      throw pmtana::OpticalRecoException("Invalid sliding window size!");
+
+    using Sum_t = std::conditional_t<std::is_integral<T>::value, std::int64_t, double>;
+
+    const size_t nwindows = wf.size() - nsample + 1;
+    mean_v.resize(nwindows);
+    sigma_v.resize(nwindows);
+
+    const Sum_t ref = std::is_integral<T>::value ? Sum_t{0} : Sum_t(wf.front());
+    const Sum_t n = nsample;
+    Sum_t sum = 0, sum2 = 0;
+
+    for (size_t i = 0; i < nsample; ++i) {
+      const Sum_t d = Sum_t(wf[i]) - ref;
+      sum += d;
+      sum2 += d * d;
+    }
+
+    for (size_t i = 0; i < nwindows; ++i) {
+
+      if (i) {
+        const Sum_t d_out = Sum_t(wf[i - 1]) - ref;
+        const Sum_t d_in = Sum_t(wf[i + nsample - 1]) - ref;
+        sum += d_in - d_out;
+        sum2 += d_in * d_in - d_out * d_out;
+      }
 
-#include "TH1D.h"
+      mean_v[i] = double(ref) + double(sum) / double(nsample);
+
+      const double var = double(n * sum2 - sum * sum) / (double(nsample) * double(nsample));
+      sigma_v[i] = var > 0 ? sqrt(var) : 0;
+    }
+  }
+
+}
 
 namespace pmtana {
 
-  double mean(const std::vector<short>& wf, size_t start, size_t nsample)
+  double mean(WaveformView_t wf, size_t start, size_t nsample)
   {
     if (!nsample) nsample = wf.size();
     if (start > wf.size() || (start + nsample) > wf.size())
@@ -22,7 +70,7 @@ namespace pmtana {
     return sum;
   }
 
-  double edge_aware_mean(const std::vector<short>& wf, int start, int end)
+  double edge_aware_mean(WaveformView_t wf, int start, int end)
   {
 
     auto m = double{0.0};
@@ -40,7 +88,7 @@ namespace pmtana {
     return m;
   }
 
-  double std(const std::vector<short>& wf, const double ped_mean, size_t start, size_t nsample)
+  double std(WaveformView_t wf, const double ped_mean, size_t start, size_t nsample)
   {
     if (!nsample) nsample = wf.size();
     if (start > wf.size() || (start + nsample) > wf.size())
@@ -57,9 +105,28 @@ namespace pmtana {
     return sigma;
   }
 
-  double BinnedMaxOccurrence(const PedestalMean_t& mean_v, const size_t nbins)
+  void sliding_mean_std(WaveformView_t wf,
+                        size_t nsample,
+                        std::vector<double>& mean_v,
+                        std::vector<double>& sigma_v)
+  {
+    sliding_mean_std_impl(wf, nsample, mean_v, sigma_v);
+  }
+
+  void sliding_mean_std(ArrayView<double> wf,
+                        size_t nsample,
+                        std::vector<double>& mean_v,
+                        std::vector<double>& sigma_v)
+  {
+    sliding_mean_std_impl(wf, nsample, mean_v, sigma_v);
+  }
+
+  double BinnedMaxOccurrence(PedestalMeanView_t mean_v,
+                             const size_t nbins,
+                             std::vector<size_t>& ctr_v)
   {
     if (nbins < 1) throw OpticalRecoException("Cannot have 0 binning");
+    if (mean_v.empty()) throw OpticalRecoException("Cannot find the mode of no values");
 
     auto res = std::minmax_element(std::begin(mean_v), std::end(mean_v));
 
@@ -67,17 +134,14 @@ namespace pmtana {
 
     if (nbins == 1 || bin_width == 0) return ((*res.first) + bin_width / 2.);
 
-    //std::cout<<"Min: "<<(*res.first)<<" Max: "<<(*res.second)<<" Width: "<<bin_width<<std::endl;
-
     // Construct array of nbins
-    static std::vector<size_t> ctr_v(nbins, 0);
-    for (auto& v : ctr_v)
-      v = 0;
+    ctr_v.assign(nbins, 0);
     for (auto const& v : mean_v) {
 
       size_t index = int((v - (*res.first)) / bin_width);
-      //std::cout<<"adc = "<<v<<" width = "<<bin_width<< " ... "
-      //<<index<<" / "<<ctr_v.size()<<std::endl;
+
+      // the maximum value belongs to the last bin
+      if (index >= nbins) index = nbins - 1;
 
       ctr_v[index]++;
     }
@@ -100,6 +164,12 @@ namespace pmtana {
     return (mean_max_occurrence / num_occurrence);
   }
 
+  double BinnedMaxOccurrence(PedestalMeanView_t mean_v, const size_t nbins)
+  {
+    std::vector<size_t> ctr_v;
+    return BinnedMaxOccurrence(mean_v, nbins, ctr_v);
+  }
+
   // template<typename W>
   int sign(double val)
   {
@@ -109,18 +179,39 @@ namespace pmtana {
     return 0;
   }
 
-  double BinnedMaxTH1D(const std::vector<double>& v, int bins)
+  double BinnedMaxTH1D(PedestalMeanView_t v, int bins, std::vector<size_t>& ctr_v)
   {
+    if (bins < 1) throw OpticalRecoException("Cannot have 0 binning");
+    if (v.empty()) throw OpticalRecoException("Cannot find the mode of no values");
 
-    auto max_it = std::max_element(std::begin(v), std::end(v));
-    auto min_it = std::min_element(std::begin(v), std::end(v));
+    auto res = std::minmax_element(std::begin(v), std::end(v));
+    double const min = *res.first;
+    double const max = *res.second;
 
-    TH1D th("th", ";;", bins, *min_it, *max_it);
+    // a histogram with no range would pick one from its content
+    if (max <= min) return min;
 
-    for (const auto& m : v)
-      th.Fill(m);
+    double const bin_width = (max - min) / bins;
 
-    return th.GetXaxis()->GetBinCenter(th.GetMaximumBin());
+    ctr_v.assign(bins, 0);
+    for (auto const& m : v) {
+      // under/overflow (the maximum included) do not contribute
+      if (!(m >= min && m < max)) continue;
+      auto index = size_t((m - min) / bin_width);
+      if (index >= ctr_v.size()) index = ctr_v.size() - 1;
+      ctr_v[index]++;
+    }
+
+    // the first bin with the largest content
+    auto const max_bin = std::max_element(std::begin(ctr_v), std::end(ctr_v)) - std::begin(ctr_v);
+
+    return min + bin_width * (max_bin + 0.5);
+  }
+
+  double BinnedMaxTH1D(PedestalMeanView_t v, int bins)
+  {
+    std::vector<size_t> ctr_v;
+    return BinnedMaxTH1D(v, bins, ctr_v);
   }
 
 }
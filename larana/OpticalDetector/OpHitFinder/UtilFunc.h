@@ -8,18 +8,58 @@
 
 namespace pmtana {
 
-  double mean(const std::vector<short>& wf, size_t start = 0, size_t nsample = 0);
+  double mean(WaveformView_t wf, size_t start = 0, size_t nsample = 0);
 
-  double edge_aware_mean(const std::vector<short>& wf, int start, int end);
+  double edge_aware_mean(WaveformView_t wf, int start, int end);
 
-  double std(const std::vector<short>& wf,
+  double std(WaveformView_t wf,
              const double ped_mean,
              size_t start = 0,
              size_t nsample = 0);
 
-  double BinnedMaxOccurrence(const PedestalMean_t& mean_v, const size_t nbins);
+  /**
+   * Computes mean and standard deviation of every window of `nsample`
+   * consecutive samples of `wf`, with running sums in a single pass.
+   * On return, `mean_v[i]` and `sigma_v[i]` are the same as
+   * `mean(wf, i, nsample)` and `std(wf, mean_v[i], i, nsample)`,
+   * for the `wf.size() - nsample + 1` windows starting at `i`.
+   */
+  void sliding_mean_std(WaveformView_t wf,
+                        size_t nsample,
+                        std::vector<double>& mean_v,
+                        std::vector<double>& sigma_v);
 
-  double BinnedMaxTH1D(const std::vector<double>& v, int bins);
+  void sliding_mean_std(ArrayView<double> wf,
+                        size_t nsample,
+                        std::vector<double>& mean_v,
+                        std::vector<double>& sigma_v);
+
+  /**
+   * Returns the most frequent value of `mean_v`, binned in `nbins` equal bins
+   * between its minimum and maximum (the maximum belongs to the last bin).
+   * If several bins share the largest count, the average of their centers is
+   * returned. `ctr_v` is scratch space for the bin counts: it is resized as
+   * needed and its content is overwritten, so that a caller can reuse it and
+   * no memory is allocated after the first call. The function has no internal
+   * state and can be called concurrently with different scratch vectors.
+   */
+  double BinnedMaxOccurrence(PedestalMeanView_t mean_v,
+                             const size_t nbins,
+                             std::vector<size_t>& ctr_v);
+
+  /// Same as above, with temporary scratch space.
+  double BinnedMaxOccurrence(PedestalMeanView_t mean_v, const size_t nbins);
+
+  /**
+   * Returns the center of the most populated of `bins` equal bins between the
+   * minimum and the maximum of `v`, the first one in case of ties. As in a
+   * `TH1D` filled with `v`, the maximum value itself is in the overflow and is
+   * not counted. `ctr_v` is scratch space as in `BinnedMaxOccurrence()`.
+   */
+  double BinnedMaxTH1D(PedestalMeanView_t v, int bins, std::vector<size_t>& ctr_v);
+
+  /// Same as above, with temporary scratch space.
+  double BinnedMaxTH1D(PedestalMeanView_t v, int bins);
 
   int sign(double val);
 
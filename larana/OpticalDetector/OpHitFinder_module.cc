@@ -15,6 +15,7 @@
 #include "larana/OpticalDetector/OpHitFinder/PMTPedestalBase.h"
 #include "larana/OpticalDetector/OpHitFinder/PMTPulseRecoBase.h"
 #include "larana/OpticalDetector/OpHitFinder/PulseRecoManager.h"
+#include "larana/OpticalDetector/OpHitFinder/PulseRecoStats.h"
 #include "larcore/CoreUtils/ServiceUtil.h" // lar::providerFrom()
 #include "larcore/Geometry/Geometry.h"
 #include "lardata/DetectorInfoServices/DetectorClocksService.h"
@@ -38,8 +39,10 @@
 // ROOT includes
 
 // C++ Includes
+#include <cstddef>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 
 namespace {
@@ -161,24 +164,46 @@ namespace opdet {
     // The producer routine, called once per event.
     void produce(art::Event&);
 
+    // Reports the waveforms skipped as quiet and the reconstruction statistics, if enabled.
+    void endJob();
+
   private:
     std::map<int, int> GetChannelMap();
     std::vector<double> GetSPEScales();
     std::vector<double> GetSPEShifts();
 
+    /// Runs the hit finding on the waveforms (or waveform pointers),
+    /// single- or multi-threaded.
+    template <typename Waveforms>
+    void RunHitFinder(Waveforms const& opDetWaveforms,
+                      std::vector<recob::OpHit>& hitVector,
+                      geo::GeometryCore const& geometry,
+                      detinfo::DetectorClocksData const& clocksData,
+                      calib::IPhotonCalibrator const& calibrator);
+
     // The parameters we'll read from the .fcl file.
     std::string fInputModule; // Input tag for OpDetWaveform collection
     std::string fGenModule;
     std::vector<std::string> fInputLabels;
     std::set<unsigned int> fChannelMasks;
 
+    // The algorithm maker tools are kept to create the per-thread algorithms.
+    std::unique_ptr<opdet::IHitAlgoMakerTool> const fHitAlgoMaker;
+    std::unique_ptr<opdet::IPedAlgoMakerTool> const fPedAlgoMaker;
+
     pmtana::PulseRecoManager fPulseRecoMgr;
     std::unique_ptr<pmtana::PMTPulseRecoBase> const fThreshAlg;
     std::unique_ptr<pmtana::PMTPedestalBase> const fPedAlg;
 
+    std::mutex fAlgoMakerMutex; // protects the maker tools when called from workers
+    HitFinderWorkers_t fHitFinderWorkers;
+
     Float_t fHitThreshold;
     unsigned int fMaxOpChannel;
     bool fUseStartTime;
+    bool fUseMultiThreading;
+    bool fSkipQuietWaveforms;
+    bool fCollectStats;
 
     calib::IPhotonCalibrator const* fCalib = nullptr;
   };
@@ -195,15 +220,28 @@ namespace opdet {
   // Constructor
   OpHitFinder::OpHitFinder(const fhicl::ParameterSet& pset)
     : EDProducer{pset}
+    , fHitAlgoMaker{art::make_tool<opdet::IHitAlgoMakerTool>(makeHitAlgoToolConfig(pset))}
+    , fPedAlgoMaker{art::make_tool<opdet::IPedAlgoMakerTool>(makePedAlgoToolConfig(pset))}
     , fPulseRecoMgr()
-    , fThreshAlg{art::make_tool<opdet::IHitAlgoMakerTool>(makeHitAlgoToolConfig(pset))->makeAlgo()}
-    , fPedAlg{art::make_tool<opdet::IPedAlgoMakerTool>(makePedAlgoToolConfig(pset))->makeAlgo()}
+    , fThreshAlg{fHitAlgoMaker->makeAlgo()}
+    , fPedAlg{fPedAlgoMaker->makeAlgo()}
+    , fHitFinderWorkers{[this]() {
+      std::lock_guard<std::mutex> const lock{fAlgoMakerMutex};
+      auto worker = std::make_unique<HitFinderWorker>(fHitAlgoMaker->makeAlgo(),
+                                                      fPedAlgoMaker->makeAlgo());
+      worker->pulseRecoMgr.SetSkipQuietWaveforms(fSkipQuietWaveforms);
+      worker->pulseRecoMgr.EnableStats(fCollectStats);
+      return worker;
+    }}
   {
     // Indicate that the Input Module comes from .fcl
     fInputModule = pset.get<std::string>("InputModule");
     fGenModule = pset.get<std::string>("GenModule");
     fInputLabels = pset.get<std::vector<std::string>>("InputLabels");
     fUseStartTime = pset.get<bool>("UseStartTime", false);
+    fUseMultiThreading = pset.get<bool>("UseMultiThreading", false);
+    fSkipQuietWaveforms = pset.get<bool>("SkipQuietWaveforms", false);
+    fCollectStats = pset.get<bool>("CollectStats", false);
 
     for (auto const& ch :
          pset.get<std::vector<unsigned int>>("ChannelMasks", std::vector<unsigned int>()))
@@ -237,12 +275,64 @@ namespace opdet {
 
     produces<std::vector<recob::OpHit>>();
 
+    // algorithms with per-channel state need all the waveforms of a channel in order,
+    // and may place the pedestal outside the range of the waveform samples
+    if (fUseMultiThreading && fPedAlg->DependsOnPreviousWaveforms()) {
+      throw art::Exception(art::errors::Configuration)
+        << "Pedestal algorithm '" << fPedAlg->Name()
+        << "' depends on the previous waveforms and can't be used with UseMultiThreading.\n";
+    }
+    if (fUseMultiThreading && !fThreshAlg->RiseTimeThreadSafe()) {
+      throw art::Exception(art::errors::Configuration)
+        << "The rise time calculator of pulse finder algorithm '" << fThreshAlg->Name()
+        << "' is not thread safe and can't be used with UseMultiThreading.\n";
+    }
+    if (fSkipQuietWaveforms && !fPedAlg->PedestalWithinSampleRange()) {
+      throw art::Exception(art::errors::Configuration)
+        << "Pedestal algorithm '" << fPedAlg->Name()
+        << "' may place the pedestal outside the samples and can't be used with "
+           "SkipQuietWaveforms.\n";
+    }
+
     fPulseRecoMgr.AddRecoAlgo(fThreshAlg.get());
     fPulseRecoMgr.SetDefaultPedAlgo(fPedAlg.get());
+    fPulseRecoMgr.SetSkipQuietWaveforms(fSkipQuietWaveforms);
+    fPulseRecoMgr.EnableStats(fCollectStats);
 
     // show the algorithm selection on screen
     mf::LogInfo{"OpHitFinder"} << "Pulse finder algorithm: '" << fThreshAlg->Name() << "'"
-                               << "\nPedestal algorithm:     '" << fPedAlg->Name() << "'";
+                               << "\nPedestal algorithm:     '" << fPedAlg->Name() << "'"
+                               << (fUseMultiThreading ? "\nRunning multi-threaded" : "")
+                               << (fSkipQuietWaveforms ? "\nSkipping quiet waveforms" : "");
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename Waveforms>
+  void OpHitFinder::RunHitFinder(Waveforms const& opDetWaveforms,
+                                 std::vector<recob::OpHit>& hitVector,
+                                 geo::GeometryCore const& geometry,
+                                 detinfo::DetectorClocksData const& clocksData,
+                                 calib::IPhotonCalibrator const& calibrator)
+  {
+    if (fUseMultiThreading)
+      opdet::RunHitFinder(opDetWaveforms,
+                          hitVector,
+                          fHitFinderWorkers,
+                          geometry,
+                          fHitThreshold,
+                          clocksData,
+                          calibrator,
+                          fUseStartTime);
+    else
+      opdet::RunHitFinder(opDetWaveforms,
+                          hitVector,
+                          fPulseRecoMgr,
+                          *fThreshAlg,
+                          geometry,
+                          fHitThreshold,
+                          clocksData,
+                          calibrator,
+                          fUseStartTime);
   }
 
   //----------------------------------------------------------------------------
@@ -264,6 +354,12 @@ namespace opdet {
     auto const clock_data =
       art::ServiceHandle<detinfo::DetectorClocksService const>()->DataFor(evt);
     auto const& calibrator(*fCalib);
+
+    // pedestal algorithms with per-channel state may need to reset it
+    fPulseRecoMgr.NewEvent();
+    for (auto& worker : fHitFinderWorkers) {
+      if (worker) worker->pulseRecoMgr.NewEvent();
+    }
     //
     // Get the pulses from the event
     //
@@ -276,55 +372,62 @@ namespace opdet {
       else
         evt.getByLabel(fInputModule, fInputLabels.front(), wfHandle);
       assert(wfHandle.isValid());
-      RunHitFinder(*wfHandle,
-                   *HitPtr,
-                   fPulseRecoMgr,
-                   *fThreshAlg,
-                   geometry,
-                   fHitThreshold,
-                   clock_data,
-                   calibrator,
-                   fUseStartTime);
+      RunHitFinder(*wfHandle, *HitPtr, geometry, clock_data, calibrator);
     }
     else {
 
-      // Reserve a large enough array
-      int totalsize = 0;
-      for (auto label : fInputLabels) {
+      // Collect the waveforms by reference, skipping the masked channels;
+      // each input collection is fetched only once and no waveform is copied
+      std::vector<art::Handle<std::vector<raw::OpDetWaveform>>> wfHandles;
+      std::size_t totalsize = 0;
+      for (auto const& label : fInputLabels) {
         art::Handle<std::vector<raw::OpDetWaveform>> wfHandle;
         evt.getByLabel(fInputModule, label, wfHandle);
         if (!wfHandle.isValid()) continue; // Skip non-existent collections
         totalsize += wfHandle->size();
+        wfHandles.push_back(std::move(wfHandle));
       }
-
-      std::vector<raw::OpDetWaveform> WaveformVector;
-      WaveformVector.reserve(totalsize);
-
-      for (auto label : fInputLabels) {
+      if (fInputLabels.empty()) {
         art::Handle<std::vector<raw::OpDetWaveform>> wfHandle;
-        evt.getByLabel(fInputModule, label, wfHandle);
-        if (!wfHandle.isValid()) continue; // Skip non-existent collections
+        evt.getByLabel(fInputModule, wfHandle);
+        if (wfHandle.isValid()) {
+          totalsize += wfHandle->size();
+          wfHandles.push_back(std::move(wfHandle));
+        }
+      }
+
+      std::vector<raw::OpDetWaveform const*> WaveformPtrs;
+      WaveformPtrs.reserve(totalsize);
 
-        //WaveformVector.insert(WaveformVector.end(),
-        //                      wfHandle->begin(), wfHandle->end());
+      for (auto const& wfHandle : wfHandles) {
         for (auto const& wf : *wfHandle) {
           if (fChannelMasks.find(wf.ChannelNumber()) != fChannelMasks.end()) continue;
-          WaveformVector.push_back(wf);
+          WaveformPtrs.push_back(&wf);
         }
       }
 
-      RunHitFinder(WaveformVector,
-                   *HitPtr,
-                   fPulseRecoMgr,
-                   *fThreshAlg,
-                   geometry,
-                   fHitThreshold,
-                   clock_data,
-                   calibrator,
-                   fUseStartTime);
+      RunHitFinder(WaveformPtrs, *HitPtr, geometry, clock_data, calibrator);
     }
     // Store results into the event
     evt.put(std::move(HitPtr));
   }
 
+  //----------------------------------------------------------------------------
+  void OpHitFinder::endJob()
+  {
+    if (!fSkipQuietWaveforms && !fCollectStats) return;
+
+    // all the managers run the same algorithms: sum the threads up
+    pmtana::PulseRecoStats stats = fPulseRecoMgr.Stats();
+    for (auto const& worker : fHitFinderWorkers) {
+      if (worker) stats.Merge(worker->pulseRecoMgr.Stats());
+    }
+
+    if (fCollectStats)
+      mf::LogInfo{"OpHitFinder"} << "Pulse reconstruction statistics:\n" << stats;
+    else
+      mf::LogInfo{"OpHitFinder"} << "Skipped " << stats.n_skipped << " quiet waveforms out of "
+                                 << stats.n_waveforms << " processed.";
+  }
+
 } // namespace opdet
@@ -23,12 +23,14 @@
 // LArSoft includes
 #include "larana/OpticalDetector/OpDetResponseInterface.h"
 #include "larana/OpticalDetector/OpDigiProperties.h"
+#include "larana/OpticalDetector/SparseWaveform.h"
 #include "lardataobj/RawData/OpDetPulse.h"
 #include "lardataobj/Simulation/SimPhotons.h"
 #include "larsim/Simulation/LArG4Parameters.h"
 #include "larsim/Simulation/SimListUtils.h"
 
 // CLHEP includes
+#include "CLHEP/Random/RandBinomial.h"
 #include "CLHEP/Random/RandFlat.h"
 #include "CLHEP/Random/RandPoisson.h"
 
@@ -36,6 +38,7 @@
 #include "nurandom/RandomUtils/NuRandomService.h"
 
 // C++ language includes
+#include <algorithm>
 #include <cstring>
 
 namespace opdet {
@@ -57,13 +60,29 @@ namespace opdet {
 
     float fDarkRate; // Noise rate in Hz
 
+    bool fBinnedConvolution; // histogram photons before adding the 1PE waveform
+    bool fSparseWaveforms;   // store only the samples around photons and dark pulses
+
     std::vector<double> fSinglePEWaveform;
 
     CLHEP::HepRandomEngine& fEngine;
     CLHEP::RandFlat fFlatRandom;
     CLHEP::RandPoisson fPoissonRandom;
+    CLHEP::RandBinomial fBinomialRandom;
+
+    void AddTimedWaveform(int time,
+                          std::vector<double>& OldPulse,
+                          std::vector<double>& NewPulse,
+                          unsigned int nPhotons = 1);
+
+    void AddBinnedWaveform(std::vector<unsigned int> const& PhotonBins,
+                           std::vector<double>& OldPulse,
+                           std::vector<double> const& NewPulse) const;
+    void AddBinnedWaveform(std::vector<unsigned int> const& PhotonBins,
+                           SparseWaveform& OldPulse,
+                           std::vector<double> const& NewPulse) const;
 
-    void AddTimedWaveform(int time, std::vector<double>& OldPulse, std::vector<double>& NewPulse);
+    short DigitizeSample(double Sample);
   };
 }
 
@@ -77,6 +96,8 @@ namespace opdet {
     , fInputModule{pset.get<std::string>("InputModule")} //, fQE{pset.get<double>("QE")}
     , fSaturationScale{pset.get<float>("SaturationScale")}
     , fDarkRate{pset.get<float>("DarkRate")}
+    , fBinnedConvolution{pset.get<bool>("BinnedConvolution", false)}
+    , fSparseWaveforms{pset.get<bool>("SparseWaveforms", false)}
     // create a default random engine; obtain the random seed from NuRandomService,
     // unless overridden in configuration with key "Seed"
     , fEngine(art::ServiceHandle<rndm::NuRandomService>()->registerAndSeedEngine(createEngine(0),
@@ -84,6 +105,7 @@ namespace opdet {
                                                                                  "Seed"))
     , fFlatRandom{fEngine}
     , fPoissonRandom{fEngine}
+    , fBinomialRandom{fEngine}
   {
     produces<std::vector<raw::OpDetPulse>>();
 
@@ -98,16 +120,77 @@ namespace opdet {
 
   void OpMCDigi::AddTimedWaveform(int binTime,
                                   std::vector<double>& OldPulse,
-                                  std::vector<double>& NewPulse)
+                                  std::vector<double>& NewPulse,
+                                  unsigned int nPhotons)
   {
 
     if ((binTime + NewPulse.size()) > OldPulse.size()) {
       OldPulse.resize(binTime + NewPulse.size());
     }
 
-    // Add shifted NewWaveform to Waveform at pointer
+    // Add shifted NewWaveform, scaled by the number of photons, to Waveform at pointer
     for (size_t i = 0; i != NewPulse.size(); ++i) {
-      OldPulse.at(binTime + i) += NewPulse.at(i);
+      OldPulse.at(binTime + i) += nPhotons * NewPulse.at(i);
+    }
+  }
+
+  //-------------------------------------------------
+
+  // Adds NewPulse once for each photon counted in PhotonBins, i.e. the
+  // convolution of the photon arrival histogram with the 1PE waveform.
+  // Only the empty bins are skipped, so the cost is proportional to the
+  // number of occupied bins rather than to the number of photons.
+  // The result is truncated to the size of OldPulse.
+  void OpMCDigi::AddBinnedWaveform(std::vector<unsigned int> const& PhotonBins,
+                                   std::vector<double>& OldPulse,
+                                   std::vector<double> const& NewPulse) const
+  {
+    size_t const nBins = std::min(PhotonBins.size(), OldPulse.size());
+
+    for (size_t binTime = 0; binTime != nBins; ++binTime) {
+      unsigned int const nPhotons = PhotonBins[binTime];
+      if (nPhotons == 0) continue;
+
+      size_t const nSamples = std::min(NewPulse.size(), OldPulse.size() - binTime);
+      double* const pulse = OldPulse.data() + binTime;
+      for (size_t i = 0; i != nSamples; ++i)
+        pulse[i] += nPhotons * NewPulse[i];
+    }
+  }
+
+  //-------------------------------------------------
+
+  void OpMCDigi::AddBinnedWaveform(std::vector<unsigned int> const& PhotonBins,
+                                   SparseWaveform& OldPulse,
+                                   std::vector<double> const& NewPulse) const
+  {
+    size_t const nBins = std::min(PhotonBins.size(), OldPulse.size());
+
+    for (size_t binTime = 0; binTime != nBins; ++binTime) {
+      if (PhotonBins[binTime] != 0) OldPulse.AddPulse(binTime, NewPulse, PhotonBins[binTime]);
+    }
+  }
+
+  //-------------------------------------------------
+
+  short OpMCDigi::DigitizeSample(double Sample)
+  {
+    // Apply saturation for large signals
+    if (Sample > fSaturationScale) Sample = fSaturationScale;
+
+    // Throw randoms to fairly sample +ve and -ve side of doubles
+    int ThisSample = Sample;
+    if (ThisSample > 0) {
+      if (fFlatRandom.fire(1.0) > (ThisSample - int(ThisSample)))
+        return int(ThisSample);
+      else
+        return int(ThisSample) + 1;
+    }
+    else {
+      if (fFlatRandom.fire(1.0) > (int(ThisSample) - ThisSample))
+        return int(ThisSample);
+      else
+        return int(ThisSample) - 1;
     }
   }
 
@@ -130,25 +213,52 @@ namespace opdet {
     int const nSamples = (TimeEnd_ns - TimeBegin_ns) * SampleFreq_ns;
     int const NOpChannels = odresponse->NOpChannels();
 
-    // This vector will store all the waveforms we will make
-    std::vector<std::vector<double>> PulsesFromDetPhotons(NOpChannels,
-                                                          std::vector<double>(nSamples, 0.0));
+    // This vector will store all the waveforms we will make;
+    // in sparse mode, only the samples around photons and dark pulses are stored
+    std::vector<std::vector<double>> PulsesFromDetPhotons;
+    std::vector<SparseWaveform> SparsePulses;
+    if (fSparseWaveforms)
+      SparsePulses.assign(NOpChannels, SparseWaveform(nSamples));
+    else
+      PulsesFromDetPhotons.assign(NOpChannels, std::vector<double>(nSamples, 0.0));
+
+    // In binned mode, photons are first counted per readout channel and
+    // sample, and the 1PE waveform is added once per occupied sample.
+    // Photons in bins past the end of the window would be truncated anyway.
+    std::vector<std::vector<unsigned int>> PhotonBins;
+    if (fBinnedConvolution) PhotonBins.assign(NOpChannels, std::vector<unsigned int>(nSamples, 0));
+
+    auto AddPhoton = [&](int readoutCh, int binTime, unsigned int nPhotons = 1) {
+      if (fBinnedConvolution) {
+        if (binTime < nSamples) PhotonBins[readoutCh][binTime] += nPhotons;
+      }
+      else if (fSparseWaveforms)
+        SparsePulses[readoutCh].AddPulse(binTime, fSinglePEWaveform, nPhotons);
+      else
+        AddTimedWaveform(binTime, PulsesFromDetPhotons[readoutCh], fSinglePEWaveform, nPhotons);
+    };
 
     if (!fUseLitePhotons) {
       // Read in the Sim Photons
       sim::SimPhotonsCollection ThePhotCollection =
         sim::SimListUtils::GetSimPhotonsCollection(evt, fInputModule);
+      std::vector<char> isDetected;
+      std::vector<int> readoutChannels;
       // For every OpDet:
       for (auto const& pr : ThePhotCollection) {
         const sim::SimPhotons& ThePhot = pr.second;
 
         int const Ch = ThePhot.OpChannel();
-        int readoutCh;
+
+        // Sample a random subset according to QE
+        odresponse->detectedBatch(Ch, ThePhot.data(), ThePhot.size(), isDetected, readoutChannels);
 
         // For every photon in the hit:
-        for (const sim::OnePhoton& Phot : ThePhot) {
-          // Sample a random subset according to QE
-          if (!odresponse->detected(Ch, Phot, readoutCh)) { continue; }
+        for (size_t iPhot = 0; iPhot != ThePhot.size(); ++iPhot) {
+          if (!isDetected[iPhot]) { continue; }
+
+          const sim::OnePhoton& Phot = ThePhot[iPhot];
+          int const readoutCh = readoutChannels[iPhot];
 
           // Convert photon arrival time to the appropriate bin,
           // dictated by fSampleFreq. Photon arrival time is in ns,
@@ -156,19 +266,38 @@ namespace opdet {
           // that we have to accommodate for the beginning time
           if ((Phot.Time > TimeBegin_ns) && (Phot.Time < TimeEnd_ns)) {
             auto const binTime = static_cast<int>((Phot.Time - TimeBegin_ns) * SampleFreq_ns);
-            AddTimedWaveform(binTime, PulsesFromDetPhotons[readoutCh], fSinglePEWaveform);
+            AddPhoton(readoutCh, binTime);
           }
         } // for each Photon in SimPhotons
       }
     }
     else {
-      auto const photons = *evt.getValidHandle<std::vector<sim::SimPhotonsLite>>("largeant");
+      auto const& photons = *evt.getValidHandle<std::vector<sim::SimPhotonsLite>>("largeant");
       // For every OpDet:
       for (auto const& photon : photons) {
         int const Ch = photon.OpChannel;
         int readoutCh;
 
-        std::map<int, int> PhotonsMap = photon.DetectedPhotons;
+        // If the response gives a detection probability for the channel,
+        // the detected photons are sampled once per arrival time
+        double probability;
+        if (odresponse->detectionProbabilityLite(Ch, probability, readoutCh)) {
+          for (auto const& pr : photon.DetectedPhotons) {
+            if ((pr.first <= TimeBegin_ns) || (pr.first >= TimeEnd_ns) || (pr.second <= 0))
+              continue;
+
+            unsigned int nDetected = pr.second;
+            if (probability <= 0.0)
+              continue;
+            else if (probability < 1.0)
+              nDetected = fBinomialRandom.fire(pr.second, probability);
+            if (nDetected == 0) continue;
+
+            auto const binTime = static_cast<int>((pr.first - TimeBegin_ns) * SampleFreq_ns);
+            AddPhoton(readoutCh, binTime, nDetected);
+          }
+          continue;
+        }
 
         // For every photon in the hit:
         for (auto const& pr : photon.DetectedPhotons) {
@@ -180,7 +309,7 @@ namespace opdet {
               // Notice that we have to accommodate for the beginning time
               if ((pr.first > TimeBegin_ns) && (pr.first < TimeEnd_ns)) {
                 auto const binTime = static_cast<int>((pr.first - TimeBegin_ns) * SampleFreq_ns);
-                AddTimedWaveform(binTime, PulsesFromDetPhotons[readoutCh], fSinglePEWaveform);
+                AddPhoton(readoutCh, binTime);
               }
             } // random QE cut
           }
@@ -193,8 +322,38 @@ namespace opdet {
 
     std::vector<raw::OpDetPulse*> ThePulses(NOpChannels);
     for (int iCh = 0; iCh != NOpChannels; ++iCh) {
+      if (fSparseWaveforms) {
+        SparseWaveform& Pulse = SparsePulses[iCh];
+
+        if (fBinnedConvolution) AddBinnedWaveform(PhotonBins[iCh], Pulse, fSinglePEWaveform);
+
+        // Add dark noise, extending the waveform like AddTimedWaveform does
+        double const MeanDarkPulses = fDarkRate * (fTimeEnd - fTimeBegin) / 1000000;
+        unsigned const int NumberOfPulses = fPoissonRandom.fire(MeanDarkPulses);
+
+        for (size_t i = 0; i != NumberOfPulses; ++i) {
+          double const PulseTime = (fTimeEnd - fTimeBegin) * fFlatRandom.fire(1.0);
+          int const binTime = static_cast<int>(PulseTime * fSampleFreq);
+
+          Pulse.AddPulse(binTime, fSinglePEWaveform, 1.0, true);
+        }
+
+        // Samples outside the stored regions carry no signal and digitize to 0
+        std::vector<short> shortvec(Pulse.size(), 0);
+        for (auto const& region : Pulse.Regions()) {
+          for (size_t i = 0; i != region.samples.size(); ++i)
+            shortvec[region.start + i] = DigitizeSample(region.samples[i]);
+        }
+
+        StoragePtr->emplace_back(iCh, shortvec, 0, fTimeBegin);
+        continue;
+      }
+
       PulsesFromDetPhotons[iCh].resize((TimeEnd_ns - TimeBegin_ns) * SampleFreq_ns);
 
+      if (fBinnedConvolution)
+        AddBinnedWaveform(PhotonBins[iCh], PulsesFromDetPhotons[iCh], fSinglePEWaveform);
+
       // Add dark noise
       double const MeanDarkPulses = fDarkRate * (fTimeEnd - fTimeBegin) / 1000000;
       unsigned const int NumberOfPulses = fPoissonRandom.fire(MeanDarkPulses);
@@ -206,32 +365,13 @@ namespace opdet {
         AddTimedWaveform(binTime, PulsesFromDetPhotons[iCh], fSinglePEWaveform);
       }
 
-      // Apply saturation for large signals
-      for (size_t i = 0; i != PulsesFromDetPhotons[iCh].size(); ++i) {
-        if (PulsesFromDetPhotons[iCh].at(i) > fSaturationScale)
-          PulsesFromDetPhotons[iCh].at(i) = fSaturationScale;
-      }
-
-      // Produce ADC pulse of integers rather than doubles
+      // Apply saturation and produce ADC pulse of integers rather than doubles
 
       std::vector<short> shortvec;
+      shortvec.reserve(PulsesFromDetPhotons[iCh].size());
 
-      for (size_t i = 0; i != PulsesFromDetPhotons[iCh].size(); ++i) {
-        // Throw randoms to fairly sample +ve and -ve side of doubles
-        int ThisSample = PulsesFromDetPhotons[iCh].at(i);
-        if (ThisSample > 0) {
-          if (fFlatRandom.fire(1.0) > (ThisSample - int(ThisSample)))
-            shortvec.push_back(int(ThisSample));
-          else
-            shortvec.push_back(int(ThisSample) + 1);
-        }
-        else {
-          if (fFlatRandom.fire(1.0) > (int(ThisSample) - ThisSample))
-            shortvec.push_back(int(ThisSample));
-          else
-            shortvec.push_back(int(ThisSample) - 1);
-        }
-      }
+      for (double const Sample : PulsesFromDetPhotons[iCh])
+        shortvec.push_back(DigitizeSample(Sample));
 
       StoragePtr->emplace_back(iCh, shortvec, 0, fTimeBegin);
 
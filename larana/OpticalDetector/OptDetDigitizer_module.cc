@@ -8,6 +8,7 @@
 
 // LArSoft includes
 #include "larana/OpticalDetector/OpDigiProperties.h"
+#include "larana/OpticalDetector/SparseWaveform.h"
 #include "larcore/Geometry/Geometry.h"
 #include "lardataobj/OpticalDetectorData/ChannelData.h"
 #include "lardataobj/OpticalDetectorData/ChannelDataGroup.h"
@@ -30,6 +31,7 @@
 #include "CLHEP/Random/RandPoisson.h"
 
 // C++ language includes
+#include <algorithm>
 #include <cstring>
 
 namespace opdet {
@@ -57,18 +59,39 @@ namespace opdet {
     std::vector<double> fSinglePEWaveform;
 
     bool fSimGainSpread;
+    bool fSparseWaveforms; // store only the samples around photons and dark pulses
 
     CLHEP::HepRandomEngine& fEngine;
     CLHEP::RandFlat fFlatRandom;
     CLHEP::RandPoisson fPoissonRandom;
-    void AddDarkNoise(std::vector<double>& RawWF, double gain);
+    std::vector<double> fUniforms; // block of flat random numbers for the digitization
+    template <typename Waveform>
+    void AddDarkNoise(Waveform& RawWF, double gain);
     void AddWaveform(optdata::TimeSlice_t time,
                      std::vector<double>& OldPulse,
                      std::vector<double>& NewPulse,
                      double factor,
                      bool extend = false);
-    optdata::ChannelData ApplyDigitization(std::vector<double> const RawWF,
-                                           optdata::Channel_t const ch) const;
+    void AddWaveform(optdata::TimeSlice_t time,
+                     SparseWaveform& OldPulse,
+                     std::vector<double>& NewPulse,
+                     double factor,
+                     bool extend = false);
+    optdata::ChannelData ApplyDigitization(std::vector<double> const& RawWF,
+                                           optdata::Channel_t const ch);
+    optdata::ChannelData ApplyDigitization(SparseWaveform const& RawWF,
+                                           optdata::Channel_t const ch);
+    void DigitizeSamples(double const* samples,
+                         std::size_t nSamples,
+                         optdata::ADC_Count_t baseMean,
+                         optdata::ADC_Count_t* counts);
+    void ApplyPedestalFluctuation(optdata::ChannelData& chData);
+    template <typename Waveform>
+    void SimulateWaveforms(sim::SimPhotonsCollection const& ThePhotCollection,
+                           std::vector<Waveform>& rawWF_HighGain,
+                           std::vector<Waveform>& rawWF_LowGain,
+                           optdata::ChannelDataGroup& rawWFGroup_HighGain,
+                           optdata::ChannelDataGroup& rawWFGroup_LowGain);
     art::ServiceHandle<OpDigiProperties> fOpDigiProperties;
     art::ServiceHandle<geo::Geometry const> fGeom;
   };
@@ -97,6 +120,7 @@ namespace opdet {
     // Input Module and histogram parameters come from .fcl
     fInputModule = pset.get<std::string>("InputModule");
     fSimGainSpread = pset.get<bool>("SimGainSpread");
+    fSparseWaveforms = pset.get<bool>("SparseWaveforms", false);
     fTimeBegin = fOpDigiProperties->TimeBegin();
     fTimeEnd = fOpDigiProperties->TimeEnd();
     fSampleFreq = fOpDigiProperties->SampleFreq();
@@ -126,7 +150,19 @@ namespace opdet {
 
   //-------------------------------------------------
 
-  void OptDetDigitizer::AddDarkNoise(std::vector<double>& RawWF, double gain)
+  void OptDetDigitizer::AddWaveform(optdata::TimeSlice_t const time,
+                                    SparseWaveform& OldPulse,
+                                    std::vector<double>& NewPulse,
+                                    double const factor,
+                                    bool const extend)
+  {
+    OldPulse.AddPulse(time, NewPulse, factor, extend);
+  }
+
+  //-------------------------------------------------
+
+  template <typename Waveform>
+  void OptDetDigitizer::AddDarkNoise(Waveform& RawWF, double gain)
   {
     // Add dark noise
     double MeanDarkPulses = fDarkRate * (fTimeEnd - fTimeBegin) / 1000000;
@@ -140,8 +176,31 @@ namespace opdet {
     }
   }
 
-  optdata::ChannelData OptDetDigitizer::ApplyDigitization(std::vector<double> const rawWF,
-                                                          optdata::Channel_t const ch) const
+  void OptDetDigitizer::DigitizeSamples(double const* samples,
+                                        std::size_t nSamples,
+                                        optdata::ADC_Count_t const baseMean,
+                                        optdata::ADC_Count_t* counts)
+  {
+    // Draw all the random numbers at once from the module engine,
+    // so that the loop below has no call and no branch
+    fUniforms.resize(nSamples);
+    fFlatRandom.fireArray(static_cast<int>(nSamples), fUniforms.data());
+    double const* uniforms = fUniforms.data();
+
+    for (std::size_t i = 0; i < nSamples; ++i) {
+      double const thisSample = samples[i];
+
+      // (a) amplitude digitization: round up with probability equal to the fraction
+      optdata::ADC_Count_t const thisCount = (optdata::ADC_Count_t)(thisSample) + baseMean +
+                                             (uniforms[i] < (thisSample - int(thisSample)));
+
+      // (b) saturation
+      counts[i] = std::min(thisCount, fSaturationScale);
+    }
+  }
+
+  optdata::ChannelData OptDetDigitizer::ApplyDigitization(std::vector<double> const& rawWF,
+                                                          optdata::Channel_t const ch)
   {
     //
     // Digitization includes...
@@ -152,29 +211,48 @@ namespace opdet {
 
     // prepare return data container
     optdata::ChannelData chData(ch);
-    chData.reserve(rawWF.size());
+    chData.resize(rawWF.size());
     optdata::ADC_Count_t baseMean(fPedMeanArray.at(ch));
-    for (optdata::TimeSlice_t time = 0; time < rawWF.size(); ++time) {
-      double thisSample = rawWF[time];
+    DigitizeSamples(rawWF.data(), rawWF.size(), baseMean, chData.data());
 
-      optdata::ADC_Count_t thisCount = (optdata::ADC_Count_t)(thisSample) + baseMean;
+    // (c) pedestal fluctuation
+    ApplyPedestalFluctuation(chData);
 
-      // (a) amplitude digitization
-      if (CLHEP::RandFlat::shoot(1.0) < (thisSample - int(thisSample))) thisCount += 1;
+    return chData;
+  }
 
-      // (b) saturation
-      if (thisCount > fSaturationScale) thisCount = fSaturationScale;
+  optdata::ChannelData OptDetDigitizer::ApplyDigitization(SparseWaveform const& rawWF,
+                                                          optdata::Channel_t const ch)
+  {
+    //
+    // Same as the dense waveform version, except that samples outside the
+    // stored regions are zero: their count is the baseline, which needs no
+    // amplitude digitization
+    //
 
-      chData.push_back(thisCount);
-    }
+    optdata::ADC_Count_t baseMean(fPedMeanArray.at(ch));
+    optdata::ADC_Count_t const baseCount = std::min(baseMean, fSaturationScale);
+    optdata::ChannelData chData(ch);
+    chData.assign(rawWF.size(), baseCount);
+
+    for (auto const& region : rawWF.Regions())
+      DigitizeSamples(
+        region.samples.data(), region.samples.size(), baseMean, chData.data() + region.start);
 
     // (c) pedestal fluctuation
+    ApplyPedestalFluctuation(chData);
+
+    return chData;
+  }
+
+  void OptDetDigitizer::ApplyPedestalFluctuation(optdata::ChannelData& chData)
+  {
     double timeSpan = chData.size() * 1.e-6 / (fOpDigiProperties->SampleFreq());
-    unsigned int nFluc = CLHEP::RandPoisson::shoot(fPedFlucRate * timeSpan);
+    unsigned int nFluc = fPoissonRandom.fire(fPedFlucRate * timeSpan);
     for (size_t i = 0; i < nFluc; ++i) {
-      optdata::TimeSlice_t pulseTime(CLHEP::RandFlat::shoot(0.0, (double)(chData.size())));
+      optdata::TimeSlice_t pulseTime(fFlatRandom.fire(0.0, (double)(chData.size())));
       optdata::ADC_Count_t amp = chData[pulseTime];
-      if (CLHEP::RandFlat::shoot(0., 1.) > 0.5) {
+      if (fFlatRandom.fire(0., 1.) > 0.5) {
         amp += fPedFlucAmp;
         if (amp > fSaturationScale) amp = fSaturationScale;
       }
@@ -182,55 +260,22 @@ namespace opdet {
         amp -= fPedFlucAmp;
       chData[pulseTime] = amp;
     }
-
-    return chData;
   }
 
   //-------------------------------------------------
 
-  void OptDetDigitizer::produce(art::Event& evt)
+  template <typename Waveform>
+  void OptDetDigitizer::SimulateWaveforms(sim::SimPhotonsCollection const& ThePhotCollection,
+                                          std::vector<Waveform>& rawWF_HighGain,
+                                          std::vector<Waveform>& rawWF_LowGain,
+                                          optdata::ChannelDataGroup& rawWFGroup_HighGain,
+                                          optdata::ChannelDataGroup& rawWFGroup_LowGain)
   {
-
-    //
-    // Event-wise initialization
-    //
-
-    // Infrastructure piece
-    std::unique_ptr<std::vector<optdata::ChannelDataGroup>> StoragePtr(
-      new std::vector<optdata::ChannelDataGroup>);
-
-    // Read in the Sim Photons
-    sim::SimPhotonsCollection ThePhotCollection =
-      sim::SimListUtils::GetSimPhotonsCollection(evt, fInputModule);
-
     // Convert units into ns from us/MHz
     double timeBegin_ns = fTimeBegin * 1000;
     double timeEnd_ns = fTimeEnd * 1000;
     double sampleFreq_ns = fSampleFreq / 1000;
 
-    // Compute # of timeslices to be stored in the output. This is defined by a user input (fcl file)
-    optdata::TimeSlice_t timeSliceWindow(fOpDigiProperties->GetTimeSlice(timeEnd_ns));
-
-    /*
-      Create output data product, optdata::ChannelDataGroup for each gain channel.
-      Note : Although the frame + sample number in DATA should have a reference of T=0 @ DAQ start time, this is
-             not handled in MC. Hence we do not set them here (use constructor default)
-    */
-    optdata::ChannelDataGroup rawWFGroup_HighGain(optdata::kHighGain);
-    optdata::ChannelDataGroup rawWFGroup_LowGain(optdata::kLowGain);
-    // Reserve entries equal to # of channels
-    rawWFGroup_HighGain.reserve(fGeom->NOpChannels());
-    rawWFGroup_LowGain.reserve(fGeom->NOpChannels());
-
-    /*
-      Define "raw" waveform container which will be filled based on G4 photon timing + SPE waveform information.
-      Note this is not completely an analog waveform because it is digitized in terms of time (as it is using std::vector).
-    */
-    std::vector<std::vector<double>> rawWF_HighGain(fGeom->NOpChannels(),
-                                                    std::vector<double>(timeSliceWindow, 0.0));
-    std::vector<std::vector<double>> rawWF_LowGain(fGeom->NOpChannels(),
-                                                   std::vector<double>(timeSliceWindow, 0.0));
-
     /*
       Start data processing ... see following steps
       (1) Loop over input array of optical photons & fill "raw" waveform container w/ corresponding SPE waveform
@@ -299,6 +344,69 @@ namespace opdet {
       rawWFGroup_HighGain.push_back(chData_HighGain);
       rawWFGroup_LowGain.push_back(chData_LowGain);
     } // for each OpDet in SimPhotonsCollection
+  }
+
+  //-------------------------------------------------
+
+  void OptDetDigitizer::produce(art::Event& evt)
+  {
+
+    //
+    // Event-wise initialization
+    //
+
+    // Infrastructure piece
+    std::unique_ptr<std::vector<optdata::ChannelDataGroup>> StoragePtr(
+      new std::vector<optdata::ChannelDataGroup>);
+
+    // Read in the Sim Photons
+    sim::SimPhotonsCollection ThePhotCollection =
+      sim::SimListUtils::GetSimPhotonsCollection(evt, fInputModule);
+
+    // Convert units into ns from us
+    double timeEnd_ns = fTimeEnd * 1000;
+
+    // Compute # of timeslices to be stored in the output. This is defined by a user input (fcl file)
+    optdata::TimeSlice_t timeSliceWindow(fOpDigiProperties->GetTimeSlice(timeEnd_ns));
+
+    /*
+      Create output data product, optdata::ChannelDataGroup for each gain channel.
+      Note : Although the frame + sample number in DATA should have a reference of T=0 @ DAQ start time, this is
+             not handled in MC. Hence we do not set them here (use constructor default)
+    */
+    optdata::ChannelDataGroup rawWFGroup_HighGain(optdata::kHighGain);
+    optdata::ChannelDataGroup rawWFGroup_LowGain(optdata::kLowGain);
+    // Reserve entries equal to # of channels
+    rawWFGroup_HighGain.reserve(fGeom->NOpChannels());
+    rawWFGroup_LowGain.reserve(fGeom->NOpChannels());
+
+    /*
+      Define "raw" waveform container which will be filled based on G4 photon timing + SPE waveform information.
+      Note this is not completely an analog waveform because it is digitized in terms of time (as it is using std::vector).
+      With SparseWaveforms, only the samples around photons and dark pulses are stored.
+    */
+    if (fSparseWaveforms) {
+      std::vector<SparseWaveform> rawWF_HighGain(fGeom->NOpChannels(),
+                                                 SparseWaveform(timeSliceWindow));
+      std::vector<SparseWaveform> rawWF_LowGain(fGeom->NOpChannels(),
+                                                SparseWaveform(timeSliceWindow));
+      SimulateWaveforms(ThePhotCollection,
+                        rawWF_HighGain,
+                        rawWF_LowGain,
+                        rawWFGroup_HighGain,
+                        rawWFGroup_LowGain);
+    }
+    else {
+      std::vector<std::vector<double>> rawWF_HighGain(fGeom->NOpChannels(),
+                                                      std::vector<double>(timeSliceWindow, 0.0));
+      std::vector<std::vector<double>> rawWF_LowGain(fGeom->NOpChannels(),
+                                                     std::vector<double>(timeSliceWindow, 0.0));
+      SimulateWaveforms(ThePhotCollection,
+                        rawWF_HighGain,
+                        rawWF_LowGain,
+                        rawWFGroup_HighGain,
+                        rawWFGroup_LowGain);
+    }
 
     StoragePtr->push_back(rawWFGroup_HighGain);
     StoragePtr->push_back(rawWFGroup_LowGain);
@@ -0,0 +1,15 @@
+/**
+ * @file   larana/OpticalDetector/PedAlgoChannelTrackerMaker_tool.cc
+ * @brief  _art_ tool to create a `pmtana::PedAlgoChannelTracker` algorithm.
+ * @date   October 16, 2026
+ */
+
+// LArSoft libraries
+#include "larana/OpticalDetector/OpHitFinder/PedAlgoChannelTracker.h"
+#include "larana/OpticalDetector/PedAlgoMakerToolBase.h"
+
+// framework libraries
+#include "art/Utilities/ToolMacros.h"
+
+// -----------------------------------------------------------------------------
+DEFINE_ART_CLASS_TOOL(opdet::PedAlgoMakerToolBase<pmtana::PedAlgoChannelTracker>)
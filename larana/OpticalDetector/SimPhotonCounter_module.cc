@@ -391,6 +391,8 @@ namespace opdet {
 
           if ((*ph_handle).size() > 0) {
             //           for(sim::SimPhotonsCollection::const_iterator itOpDet=TheHitCollection.begin(); itOpDet!=TheHitCollection.end(); itOpDet++)
+            std::vector<char> isDetected;
+            std::vector<int> readoutChannels;
             for (auto const& itOpDet : (*ph_handle)) {
               //Reset Counters
               fCountOpDetAll = 0;
@@ -405,12 +407,18 @@ namespace opdet {
 
               //std::cout<<"OpDet " << fOpChannel << " has size " << TheHit.size()<<std::endl;
 
+              // Detection of all the phots of the OpDet at once
+              odresponse->detectedBatch(
+                fOpChannel, TheHit.data(), TheHit.size(), isDetected, readoutChannels);
+
               // Loop through OpDet phots.
               //   Note we make the screen output decision outside the loop
               //   in order to avoid evaluating large numbers of unnecessary
               //   if conditions.
 
-              for (const sim::OnePhoton& Phot : TheHit) {
+              for (size_t iPhot = 0; iPhot != TheHit.size(); ++iPhot) {
+                const sim::OnePhoton& Phot = TheHit[iPhot];
+
                 // Calculate wavelength in nm
                 fWavelength = odresponse->wavelength(Phot.Energy);
 
@@ -428,7 +436,7 @@ namespace opdet {
                     }
                   }
 
-                  if (odresponse->detected(fOpChannel, Phot)) {
+                  if (isDetected[iPhot]) {
                     if (fMakeDetectedPhotonsTree) fThePhotonTreeDetected->Fill();
                     //only store direct direct light
                     if (!isVisible(fWavelength)) fCountOpDetDetected++;
@@ -462,7 +470,7 @@ namespace opdet {
                     }
                   }
 
-                  if (odresponse->detected(fOpChannel, Phot)) {
+                  if (isDetected[iPhot]) {
                     if (fMakeDetectedPhotonsTree) fThePhotonTreeDetected->Fill();
                     //only store direct direct light
                     if (!Reflected) fCountOpDetDetected++;
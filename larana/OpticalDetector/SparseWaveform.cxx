@@ -0,0 +1,91 @@
+/*!
+ * Title:   SparseWaveform Class
+ *
+ * Description: Simulated waveform stored as the list of the regions where
+ *              pulses were added; all the other samples are zero.
+*/
+
+#include "SparseWaveform.h"
+
+#include <algorithm>
+#include <iterator>
+
+void opdet::SparseWaveform::resize(std::size_t size)
+{
+  fSize = size;
+
+  // drop the regions starting past the end, and trim the last one
+  auto const last = std::partition_point(
+    fRegions.begin(), fRegions.end(), [size](Region const& r) { return r.start < size; });
+  fRegions.erase(last, fRegions.end());
+  if (!fRegions.empty() && fRegions.back().end() > size)
+    fRegions.back().samples.resize(size - fRegions.back().start);
+}
+
+void opdet::SparseWaveform::AddPulse(std::size_t time,
+                                     std::vector<double> const& shape,
+                                     double factor,
+                                     bool extend)
+{
+  if (extend && time + shape.size() > fSize) fSize = time + shape.size();
+  if (time >= fSize || shape.empty()) return;
+
+  std::size_t const end = std::min(time + shape.size(), fSize);
+
+  // regions overlapping or adjacent to [ time, end ) are merged into one
+  auto const first = std::partition_point(
+    fRegions.begin(), fRegions.end(), [time](Region const& r) { return r.end() < time; });
+  auto const last = std::partition_point(
+    first, fRegions.end(), [end](Region const& r) { return r.start <= end; });
+
+  Region* region = nullptr;
+  if (first == last)
+    region = &*fRegions.insert(first, Region{time, {}});
+  else {
+    std::size_t const start = std::min(time, first->start);
+    std::size_t const stop = std::max(end, std::prev(last)->end());
+    if (std::next(first) == last) {
+      // a single region, extended if needed
+      if (first->start > start)
+        first->samples.insert(first->samples.begin(), first->start - start, 0.0);
+      first->start = start;
+    }
+    else {
+      Region merged{start, std::vector<double>(stop - start, 0.0)};
+      for (auto it = first; it != last; ++it)
+        std::copy(
+          it->samples.begin(), it->samples.end(), merged.samples.begin() + (it->start - start));
+      *first = std::move(merged);
+      fRegions.erase(std::next(first), last);
+    }
+    region = &*first;
+  }
+  if (region->end() < end) region->samples.resize(end - region->start, 0.0);
+
+  double* const samples = region->samples.data() + (time - region->start);
+  for (std::size_t i = 0; i != end - time; ++i)
+    samples[i] += shape[i] * factor;
+}
+
+std::size_t opdet::SparseWaveform::NStoredSamples() const
+{
+  std::size_t n = 0;
+  for (auto const& region : fRegions)
+    n += region.samples.size();
+  return n;
+}
+
+double opdet::SparseWaveform::Sample(std::size_t time) const
+{
+  auto const it = std::partition_point(
+    fRegions.begin(), fRegions.end(), [time](Region const& r) { return r.end() <= time; });
+  if (it == fRegions.end() || it->start > time) return 0.0;
+  return it->samples[time - it->start];
+}
+
+void opdet::SparseWaveform::Fill(std::vector<double>& dense) const
+{
+  dense.assign(fSize, 0.0);
+  for (auto const& region : fRegions)
+    std::copy(region.samples.begin(), region.samples.end(), dense.begin() + region.start);
+}
@@ -0,0 +1,67 @@
+#ifndef SPARSEWAVEFORM_H
+#define SPARSEWAVEFORM_H
+
+/*!
+ * Title:   SparseWaveform Class
+ *
+ * Description: Simulated waveform stored as the list of the regions where
+ *              pulses were added; all the other samples are zero. It replaces
+ *              a dense waveform buffer when only a small fraction of a long
+ *              readout window carries signal.
+*/
+
+#include <cstddef>
+#include <vector>
+
+namespace opdet {
+
+  class SparseWaveform {
+
+  public:
+    /// A contiguous range of samples starting at `start`
+    struct Region {
+      std::size_t start;
+      std::vector<double> samples;
+
+      std::size_t end() const { return start + samples.size(); }
+    };
+
+    explicit SparseWaveform(std::size_t size = 0) : fSize(size) {}
+
+    /// Number of samples of the waveform, including the zero ones
+    std::size_t size() const { return fSize; }
+
+    /// Changes the number of samples, dropping the regions past the new end
+    void resize(std::size_t size);
+
+    /// Removes all the regions, keeping the size
+    void clear() { fRegions.clear(); }
+
+    /// Adds `shape` scaled by `factor` starting at sample `time`; samples past
+    /// the end are dropped, unless `extend` is set, in which case the
+    /// waveform grows to include all of them
+    void AddPulse(std::size_t time,
+                  std::vector<double> const& shape,
+                  double factor = 1.0,
+                  bool extend = false);
+
+    /// Non-overlapping, non-adjacent regions sorted by start sample
+    std::vector<Region> const& Regions() const { return fRegions; }
+
+    /// Number of samples actually stored
+    std::size_t NStoredSamples() const;
+
+    /// Value of a single sample
+    double Sample(std::size_t time) const;
+
+    /// Writes the waveform in a dense buffer of size() samples
+    void Fill(std::vector<double>& dense) const;
+
+  private:
+    std::size_t fSize;
+    std::vector<Region> fRegions;
+  };
+
+}
+
+#endif
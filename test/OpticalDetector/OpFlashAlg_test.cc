@@ -3,7 +3,13 @@
 
 #include "larana/OpticalDetector/OpFlashAlg.h"
 
+#include "cetlib_except/exception.h"
+
+#include <algorithm>
 #include <cmath> // std::exp
+#include <limits>
+#include <numeric> // std::iota()
+#include <random>
 
 constexpr float FlashThreshold = 50;
 constexpr double WidthTolerance = 0.5;
@@ -103,6 +109,57 @@ BOOST_AUTO_TEST_CASE(FillAccumulator_checkMultipleHits)
   BOOST_TEST(FlashesInAccumulator.size() == 1U);
 }
 
+BOOST_AUTO_TEST_CASE(FillAccumulator_checkContributorsCSR)
+{
+  std::vector<double> const times{0.5, 2.2, 0.1, 2.9, 5.0};
+  std::vector<double> const PEs{30, 10, 30, 45, 5};
+
+  std::vector<recob::OpHit> HitVector;
+  for (size_t i = 0; i < times.size(); i++)
+    HitVector.emplace_back(0, times[i], 0, 0, 0, 0, 0, PEs[i], 0);
+
+  opdet::FlashFinderScratch::Accumulator Accum;
+  opdet::FillAccumulator(HitVector, 0.1, 1.0, 0.0, FlashThreshold, Accum);
+
+  BOOST_TEST(Accum.Binned.size() == 5U);
+  BOOST_TEST(Accum.Binned[0] == 60.0);
+  BOOST_TEST(Accum.Binned[1] == 0.0);
+  BOOST_TEST(Accum.Binned[2] == 55.0);
+  BOOST_TEST(Accum.Binned[4] == 5.0);
+
+  std::vector<std::size_t> const expectedStart{0, 2, 2, 4, 4, 5};
+  std::vector<int> const expectedContributors{0, 2, 1, 3, 4};
+  BOOST_TEST(Accum.ContributorStart == expectedStart, boost::test_tools::per_element());
+  BOOST_TEST(Accum.Contributors == expectedContributors, boost::test_tools::per_element());
+
+  std::vector<int> const expectedFlashes{0, 2};
+  BOOST_TEST(Accum.FlashesInAccumulator == expectedFlashes, boost::test_tools::per_element());
+}
+
+BOOST_AUTO_TEST_CASE(AssignHitsToFlash_checkScratch)
+{
+  std::vector<double> const times{0.5, 2.2, 0.1, 2.9, 5.0};
+  std::vector<double> const PEs{30, 10, 30, 45, 5};
+
+  std::vector<recob::OpHit> HitVector;
+  for (size_t i = 0; i < times.size(); i++)
+    HitVector.emplace_back(0, times[i], 0, 0, 0, 0, 0, PEs[i], 0);
+
+  opdet::FlashFinderScratch scratch;
+  opdet::FillAccumulator(HitVector, 0.1, 1.0, 0.0, FlashThreshold, scratch.Accumulators[0]);
+  opdet::FillAccumulator(HitVector, 0.1, 1.0, 0.5, FlashThreshold, scratch.Accumulators[1]);
+
+  opdet::AssignHitsToFlash(HitVector, FlashThreshold, scratch);
+
+  // the second accumulator finds the largest flash again, with no hits left
+  std::vector<std::size_t> const expectedStart{0, 2, 4};
+  std::vector<int> const expectedHits{0, 2, 1, 3};
+  std::vector<int> const expectedClaims{0, 1, 0, 1, -1};
+  BOOST_TEST(scratch.FlashHitStart == expectedStart, boost::test_tools::per_element());
+  BOOST_TEST(scratch.FlashHits == expectedHits, boost::test_tools::per_element());
+  BOOST_TEST(scratch.HitClaimedByFlash == expectedClaims, boost::test_tools::per_element());
+}
+
 BOOST_AUTO_TEST_CASE(FillFlashesBySizeMap_checkNoFlash)
 {
   const size_t vector_size = 10;
@@ -1084,6 +1141,62 @@ BOOST_AUTO_TEST_CASE(MarkFlashesForRemoval_RemoveOneFlash)
   BOOST_TEST(FlashVector[2].TotalPE() == 100);
 }
 
+BOOST_AUTO_TEST_CASE(MarkFlashesForRemoval_BeyondHorizon)
+{
+  size_t NFlashes = 2;
+  size_t BeginFlash = 0;
+
+  std::vector<double> PEs(30, 0);
+  PEs.at(0) = 100;
+  std::vector<double> PEs_Small(30, 0);
+  PEs_Small.at(0) = 5;
+  std::vector<double> WireCenters(3, 0);
+  std::vector<double> WireWidths(3, 0);
+
+  std::vector<recob::OpFlash> FlashVector;
+  FlashVector.emplace_back(0,   //time
+                           0.5, //TimeWidth,
+                           0,   //AveAbsTime,
+                           0,   //Frame,
+                           PEs,
+                           0, //InBeamFrame,
+                           0, //OnBeamTime,
+                           0, //FastToTotal,
+                           0, //meany,
+                           0, //widthy,
+                           0, //meanz,
+                           0, //widthz,
+                           WireCenters,
+                           WireWidths);
+  FlashVector.emplace_back(1.6, //time
+                           0.5, //TimeWidth,
+                           0,   //AveAbsTime,
+                           0,   //Frame,
+                           PEs_Small,
+                           0, //InBeamFrame,
+                           0, //OnBeamTime,
+                           0, //FastToTotal,
+                           0, //meany,
+                           0, //widthy,
+                           0, //meanz,
+                           0, //widthz,
+                           WireCenters,
+                           WireWidths);
+
+  // the small flash is late light, but it is not checked beyond the horizon
+  std::vector<bool> MarkedForRemoval(NFlashes - BeginFlash, false);
+  opdet::MarkFlashesForRemoval(FlashVector, BeginFlash, MarkedForRemoval, 1.0);
+
+  BOOST_TEST(MarkedForRemoval[0] == false);
+  BOOST_TEST(MarkedForRemoval[1] == false);
+
+  MarkedForRemoval.assign(NFlashes - BeginFlash, false);
+  opdet::MarkFlashesForRemoval(FlashVector, BeginFlash, MarkedForRemoval, 2.0);
+
+  BOOST_TEST(MarkedForRemoval[0] == false);
+  BOOST_TEST(MarkedForRemoval[1] == true);
+}
+
 BOOST_AUTO_TEST_CASE(MarkFlashesForRemoval_IgnoreFirstFlash)
 {
   size_t NFlashes = 4;
@@ -1276,4 +1389,196 @@ BOOST_AUTO_TEST_CASE(RemoveFlashesFromVectors_NoFlashes)
   BOOST_TEST(FlashVector.size() == NFlashes);
 }
 
+// Makes a flash with the time, width and light of the hits as `ConstructFlash()`
+// does, with no geometry information.
+void MakeFlashWithoutGeometry(std::vector<int> const& HitsPerFlashVec,
+                              std::vector<recob::OpHit> const& HitVector,
+                              std::vector<recob::OpFlash>& FlashVector)
+{
+  double MaxTime = -std::numeric_limits<double>::max();
+  double MinTime = std::numeric_limits<double>::max();
+  double AveTime = 0, FastToTotal = 0, AveAbsTime = 0, TotalPE = 0;
+  std::vector<double> PEs(30, 0);
+  for (auto const& HitID : HitsPerFlashVec)
+    opdet::AddHitContribution(
+      HitVector.at(HitID), MaxTime, MinTime, AveTime, FastToTotal, AveAbsTime, TotalPE, PEs);
+
+  std::vector<double> const WireCenters(3, 0);
+  std::vector<double> const WireWidths(3, 0);
+  FlashVector.emplace_back(AveTime / TotalPE,         //time
+                           (MaxTime - MinTime) / 2.0, //TimeWidth,
+                           AveAbsTime / TotalPE,      //AveAbsTime,
+                           0,                         //Frame,
+                           PEs,
+                           0,                     //InBeamFrame,
+                           0,                     //OnBeamTime,
+                           FastToTotal / TotalPE, //FastToTotal,
+                           0,                     //meany,
+                           0,                     //widthy,
+                           0,                     //meanz,
+                           0,                     //widthz,
+                           WireCenters,
+                           WireWidths);
+}
+
+// Random hits sorted by time: flashes (often across accumulator bins), some of
+// them followed by a dimmer one (possibly late light), on top of single
+// photoelectron noise.
+std::vector<recob::OpHit> MakeRandomHits(unsigned int seed)
+{
+  std::mt19937 engine(seed);
+  std::uniform_real_distribution<double> uniform;
+  std::normal_distribution<double> jitter(0.0, 0.3);
+  std::exponential_distribution<double> hitPE(1.0 / 15.0);
+
+  std::vector<recob::OpHit> HitVector;
+  auto const addHit = [&](double time, double PE) {
+    int const channel = static_cast<int>(uniform(engine) * 30);
+    double const width = 0.05 + 0.2 * uniform(engine);
+    HitVector.emplace_back(channel, time, time, 0, width, 0, 0, PE, 0.3);
+  };
+  auto const addFlash = [&](double time, int nHits) {
+    for (int iHit = 0; iHit < nHits; ++iHit)
+      addHit(time + jitter(engine), hitPE(engine));
+  };
+
+  for (int iFlash = 0; iFlash < 150; ++iFlash) {
+    double const time = 500.0 * uniform(engine);
+    addFlash(time, 3 + static_cast<int>(uniform(engine) * 20));
+    if (uniform(engine) < 0.5)
+      addFlash(time + 0.5 + 4.5 * uniform(engine), 2 + static_cast<int>(uniform(engine) * 6));
+  }
+  for (int iNoise = 0; iNoise < 500; ++iNoise)
+    addHit(500.0 * uniform(engine), 0.5 + 2.5 * uniform(engine));
+
+  std::sort(HitVector.begin(), HitVector.end(), [](recob::OpHit const& a, recob::OpHit const& b) {
+    return a.PeakTime() < b.PeakTime();
+  });
+  return HitVector;
+}
+
+// Hit lists of the flashes found in `HitVector` all at once and not removed as
+// late light, sorted by flash time; `NRemoved` is set to the removed flashes.
+std::vector<std::vector<int>> FindFlashesAtOnce(std::vector<recob::OpHit> const& HitVector,
+                                                double BinWidth,
+                                                double LateLightHorizon,
+                                                std::size_t& NRemoved)
+{
+  double minTime = std::numeric_limits<float>::max();
+  for (auto const& hit : HitVector)
+    minTime = std::min(minTime, hit.PeakTime());
+
+  opdet::FlashFinderScratch scratch;
+  opdet::FillAccumulator(
+    HitVector, minTime, BinWidth, 0.0, FlashThreshold, scratch.Accumulators[0]);
+  opdet::FillAccumulator(
+    HitVector, minTime, BinWidth, BinWidth / 2.0, FlashThreshold, scratch.Accumulators[1]);
+  opdet::AssignHitsToFlash(HitVector, FlashThreshold, scratch);
+
+  std::vector<std::vector<int>> RefinedHitsPerFlash;
+  scratch.HitsUsed.assign(HitVector.size(), false);
+  for (std::size_t iFlash = 0; iFlash + 1 < scratch.FlashHitStart.size(); ++iFlash)
+    opdet::RefineHitsInFlash(scratch.FlashHits.data() + scratch.FlashHitStart[iFlash],
+                             scratch.FlashHits.data() + scratch.FlashHitStart[iFlash + 1],
+                             HitVector,
+                             RefinedHitsPerFlash,
+                             WidthTolerance,
+                             FlashThreshold,
+                             scratch);
+
+  std::vector<recob::OpFlash> Flashes;
+  for (auto const& HitsPerFlashVec : RefinedHitsPerFlash)
+    MakeFlashWithoutGeometry(HitsPerFlashVec, HitVector, Flashes);
+
+  std::vector<int> order(Flashes.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&Flashes](int a, int b) {
+    return Flashes[a].Time() < Flashes[b].Time();
+  });
+  std::vector<recob::OpFlash> SortedFlashes;
+  for (int const iFlash : order)
+    SortedFlashes.push_back(Flashes[iFlash]);
+
+  std::vector<bool> MarkedForRemoval(SortedFlashes.size(), false);
+  opdet::MarkFlashesForRemoval(SortedFlashes, 0, MarkedForRemoval, LateLightHorizon);
+
+  std::vector<std::vector<int>> KeptHitsPerFlash;
+  NRemoved = 0;
+  for (std::size_t iFlash = 0; iFlash < order.size(); ++iFlash) {
+    if (MarkedForRemoval[iFlash])
+      ++NRemoved;
+    else
+      KeptHitsPerFlash.push_back(RefinedHitsPerFlash[order[iFlash]]);
+  }
+  return KeptHitsPerFlash;
+}
+
+// Feeds random hits to a `StreamingFlashFinder` in chunks of `ChunkSize` (each
+// one shuffled) and compares the flashes with the ones found all at once.
+void CheckStreamingFlashFinder(std::size_t ChunkSize, unsigned int seed)
+{
+  constexpr double BinWidth = 1.0;
+
+  std::vector<recob::OpHit> HitVector = MakeRandomHits(seed);
+  std::mt19937 engine(seed);
+  for (std::size_t iHit = 0; iHit < HitVector.size(); iHit += ChunkSize) {
+    auto const ChunkEnd = HitVector.begin() + std::min(iHit + ChunkSize, HitVector.size());
+    std::shuffle(HitVector.begin() + iHit, ChunkEnd, engine);
+  }
+
+  for (double const LateLightHorizon : {std::numeric_limits<double>::infinity(), 2.0}) {
+    std::size_t NRemoved = 0;
+    std::vector<std::vector<int>> const expected =
+      FindFlashesAtOnce(HitVector, BinWidth, LateLightHorizon, NRemoved);
+    BOOST_TEST(expected.size() > 20U);
+    BOOST_TEST(NRemoved > 0U);
+
+    opdet::StreamingFlashFinder finder(
+      BinWidth, FlashThreshold, WidthTolerance, 0, LateLightHorizon);
+    std::vector<recob::OpFlash> FlashVector;
+    std::vector<std::vector<int>> AssocList;
+    std::vector<recob::OpHit> Chunk;
+    for (std::size_t iHit = 0; iHit < HitVector.size(); iHit += ChunkSize) {
+      Chunk.assign(HitVector.begin() + iHit,
+                   HitVector.begin() + std::min(iHit + ChunkSize, HitVector.size()));
+      finder.AddHits(Chunk, FlashVector, AssocList, MakeFlashWithoutGeometry);
+    }
+    finder.Finish(FlashVector, AssocList, MakeFlashWithoutGeometry);
+
+    BOOST_TEST(FlashVector.size() == AssocList.size());
+    BOOST_TEST_REQUIRE(AssocList.size() == expected.size());
+    for (std::size_t iFlash = 0; iFlash < expected.size(); ++iFlash)
+      BOOST_TEST(AssocList[iFlash] == expected[iFlash], boost::test_tools::per_element());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(StreamingFlashFinder_ChunksOf1)
+{
+  CheckStreamingFlashFinder(1, 1234);
+}
+
+BOOST_AUTO_TEST_CASE(StreamingFlashFinder_ChunksOf7)
+{
+  CheckStreamingFlashFinder(7, 2345);
+}
+
+BOOST_AUTO_TEST_CASE(StreamingFlashFinder_OneChunk)
+{
+  CheckStreamingFlashFinder(std::numeric_limits<std::size_t>::max() / 2, 3456);
+}
+
+BOOST_AUTO_TEST_CASE(StreamingFlashFinder_OutOfOrderChunk)
+{
+  std::vector<recob::OpHit> FirstChunk, SecondChunk;
+  FirstChunk.emplace_back(0, 10.0, 10.0, 0, 0.1, 0, 0, 100, 0);
+  SecondChunk.emplace_back(0, 9.5, 9.5, 0, 0.1, 0, 0, 100, 0);
+
+  opdet::StreamingFlashFinder finder(1.0, FlashThreshold, WidthTolerance, 0, 2.0);
+  std::vector<recob::OpFlash> FlashVector;
+  std::vector<std::vector<int>> AssocList;
+  finder.AddHits(FirstChunk, FlashVector, AssocList, MakeFlashWithoutGeometry);
+  BOOST_CHECK_THROW(finder.AddHits(SecondChunk, FlashVector, AssocList, MakeFlashWithoutGeometry),
+                    cet::exception);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,569 @@
+/**
+ * @file   OpHitFinder_benchmark.cc
+ * @brief  Throughput benchmark of the optical hit and flash finding algorithms.
+ *
+ * Synthetic `raw::OpDetWaveform` sets (baseline with gaussian noise and
+ * single photoelectron-like pulses) are reconstructed outside of _art_ with
+ * each of the pedestal algorithms combined with each of the pulse algorithms,
+ * and the throughput (samples per second) and the number of memory
+ * allocations per waveform are reported for each combination.
+ * All the pulse algorithms are also run together on a single (shared) pedestal.
+ * The benchmark also checks that skipping the quiet waveforms and sharing the
+ * pedestal do not change the pulses found: each combination is run again
+ * with quiet waveform skipping and its pulses compared waveform by waveform,
+ * and the pulse count of each algorithm on the shared pedestal is compared to
+ * the one of its own run. Any difference is reported, and makes the exit code
+ * non-zero.
+ * The hits from an Edges + SlidingWindow reconstruction are then clustered
+ * into flashes by the accumulator stage of the flash finder, which does not
+ * need the geometry.
+ *
+ * Usage:
+ *
+ *     OpHitFinder_benchmark [options]
+ *
+ *     --channels N       number of channels (waveforms) per event [100]
+ *     --length N         samples per waveform [5000]
+ *     --events N         number of events [5]
+ *     --rate R           mean number of pulses per 1000 samples [1]
+ *     --noise S          baseline noise RMS in ADC counts [0.5]
+ *     --seed N           random seed [12345]
+ *     --stats 0|1        also print the time and counters of each algorithm [0]
+ *
+ * The defaults are small enough to run as a test.
+ */
+
+#include "larana/OpticalDetector/OpFlashAlg.h"
+#include "larana/OpticalDetector/OpHitFinder/AlgoCFD.h"
+#include "larana/OpticalDetector/OpHitFinder/AlgoFixedWindow.h"
+#include "larana/OpticalDetector/OpHitFinder/AlgoSiPM.h"
+#include "larana/OpticalDetector/OpHitFinder/AlgoSlidingWindow.h"
+#include "larana/OpticalDetector/OpHitFinder/AlgoThreshold.h"
+#include "larana/OpticalDetector/OpHitFinder/PedAlgoEdges.h"
+#include "larana/OpticalDetector/OpHitFinder/PedAlgoRmsSlider.h"
+#include "larana/OpticalDetector/OpHitFinder/PedAlgoRollingMean.h"
+#include "larana/OpticalDetector/OpHitFinder/PedAlgoUB.h"
+#include "larana/OpticalDetector/OpHitFinder/PulseRecoManager.h"
+
+#include "fhiclcpp/ParameterSet.h"
+#include "lardataobj/RawData/OpDetWaveform.h"
+#include "lardataobj/RecoBase/OpHit.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <new>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+//------------------------------------------------------------------------------
+// Allocation counting: all the global allocations of the program are counted.
+// The replacements are not inlined, so that the compiler does not see their
+// malloc/free pairing against the new/delete one (-Wmismatched-new-delete).
+namespace {
+  std::size_t gAllocations = 0;
+}
+
+[[gnu::noinline]] void* operator new(std::size_t size)
+{
+  ++gAllocations;
+  if (void* p = std::malloc(size ? size : 1)) return p;
+  throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void* operator new[](std::size_t size)
+{
+  return ::operator new(size);
+}
+
+[[gnu::noinline]] void* operator new(std::size_t size, std::nothrow_t const&) noexcept
+{
+  ++gAllocations;
+  return std::malloc(size ? size : 1);
+}
+
+[[gnu::noinline]] void* operator new[](std::size_t size, std::nothrow_t const& tag) noexcept
+{
+  return ::operator new(size, tag);
+}
+
+[[gnu::noinline]] void operator delete(void* p) noexcept
+{
+  std::free(p);
+}
+
+[[gnu::noinline]] void operator delete[](void* p) noexcept
+{
+  std::free(p);
+}
+
+[[gnu::noinline]] void operator delete(void* p, std::size_t) noexcept
+{
+  std::free(p);
+}
+
+[[gnu::noinline]] void operator delete[](void* p, std::size_t) noexcept
+{
+  std::free(p);
+}
+
+[[gnu::noinline]] void operator delete(void* p, std::nothrow_t const&) noexcept
+{
+  std::free(p);
+}
+
+[[gnu::noinline]] void operator delete[](void* p, std::nothrow_t const&) noexcept
+{
+  std::free(p);
+}
+
+namespace {
+
+  struct Config {
+    unsigned int nChannels = 100;
+    unsigned int length = 5000;
+    unsigned int nEvents = 5;
+    double rate = 1.0;
+    double noise = 0.5;
+    unsigned int seed = 12345;
+    bool stats = false;
+  };
+
+  constexpr short Baseline = 1500;
+  constexpr double TickPeriod = 0.002; // us
+  constexpr double AreaPerPE = 100.0;  // ADC x tick
+
+  //----------------------------------------------------------------------------
+  Config ParseArguments(int argc, char** argv)
+  {
+    Config config;
+    for (int iArg = 1; iArg < argc; ++iArg) {
+      std::string const arg = argv[iArg];
+      if (iArg + 1 >= argc) throw std::runtime_error("Missing value for option '" + arg + "'");
+      char const* value = argv[++iArg];
+      if (arg == "--channels")
+        config.nChannels = std::stoul(value);
+      else if (arg == "--length")
+        config.length = std::stoul(value);
+      else if (arg == "--events")
+        config.nEvents = std::stoul(value);
+      else if (arg == "--rate")
+        config.rate = std::stod(value);
+      else if (arg == "--noise")
+        config.noise = std::stod(value);
+      else if (arg == "--seed")
+        config.seed = std::stoul(value);
+      else if (arg == "--stats")
+        config.stats = std::stoul(value) != 0;
+      else
+        throw std::runtime_error("Unknown option '" + arg + "'");
+    }
+    return config;
+  }
+
+  //----------------------------------------------------------------------------
+  /// Generates the waveforms of all the events (positive polarity pulses).
+  std::vector<std::vector<raw::OpDetWaveform>> GenerateEvents(Config const& config)
+  {
+    std::mt19937 engine(config.seed);
+    std::normal_distribution<double> noise(0.0, config.noise);
+    std::poisson_distribution<unsigned int> nPulses(config.rate * config.length / 1000.0);
+    std::uniform_real_distribution<double> uniform;
+    std::exponential_distribution<double> amplitude(1.0 / 20.0);
+
+    // pulse shape: fast rise and exponential decay
+    std::vector<double> shape(60);
+    for (std::size_t i = 0; i < shape.size(); ++i)
+      shape[i] = (1.0 - std::exp(-(i / 1.5))) * std::exp(-(i / 8.0));
+
+    std::vector<std::vector<raw::OpDetWaveform>> events(config.nEvents);
+    for (unsigned int iEvent = 0; iEvent < config.nEvents; ++iEvent) {
+      auto& waveforms = events[iEvent];
+      waveforms.reserve(config.nChannels);
+      for (unsigned int channel = 0; channel < config.nChannels; ++channel) {
+        std::vector<double> samples(config.length);
+        for (auto& sample : samples)
+          sample = Baseline + noise(engine);
+        for (unsigned int iPulse = nPulses(engine); iPulse > 0; --iPulse) {
+          std::size_t const start = uniform(engine) * config.length;
+          double const height = 5.0 + amplitude(engine);
+          for (std::size_t i = 0; i < shape.size() && start + i < samples.size(); ++i)
+            samples[start + i] += height * shape[i];
+        }
+        raw::OpDetWaveform waveform(0.0, channel, config.length);
+        for (std::size_t i = 0; i < samples.size(); ++i)
+          waveform[i] = static_cast<short>(std::lround(samples[i]));
+        waveforms.push_back(std::move(waveform));
+      }
+    }
+    return events;
+  }
+
+  //----------------------------------------------------------------------------
+  // Algorithm configurations, as the standard ones in opticaldetectormodules.fcl
+  // (pulses are positive in the synthetic waveforms).
+  fhicl::ParameterSet EdgesConfiguration()
+  {
+    fhicl::ParameterSet pset;
+    pset.put("NumSampleFront", 3);
+    pset.put("NumSampleTail", 3);
+    pset.put("Method", 0);
+    return pset;
+  }
+
+  fhicl::ParameterSet RollingMeanConfiguration()
+  {
+    fhicl::ParameterSet pset;
+    pset.put("SampleSize", 2);
+    pset.put("MaxSigma", 0.5);
+    pset.put("PedRangeMax", 2150);
+    pset.put("PedRangeMin", 100);
+    pset.put("Threshold", 4);
+    pset.put("DiffBetweenGapsThreshold", 2);
+    pset.put("DiffADCCounts", 2);
+    pset.put("NPrePostSamples", 5);
+    return pset;
+  }
+
+  fhicl::ParameterSet RmsSliderConfiguration()
+  {
+    fhicl::ParameterSet pset;
+    pset.put("SampleSize", 7);
+    pset.put("Threshold", 0.6);
+    pset.put("MaxSigma", 0.5);
+    pset.put("PedRangeMax", 2150);
+    pset.put("PedRangeMin", 100);
+    pset.put("NumPreSample", 10);
+    pset.put("NumPostSample", 20);
+    pset.put("Verbose", false);
+    pset.put("NWaveformsToFile", 0);
+    return pset;
+  }
+
+  fhicl::ParameterSet UBConfiguration()
+  {
+    fhicl::ParameterSet pset = RollingMeanConfiguration();
+    pset.put("BeamGateSamples", 1500);
+    // for the PedAlgoRmsSlider used in the beam gate, quiet and without file output
+    pset.put("Verbose", false);
+    pset.put("NWaveformsToFile", 0);
+    return pset;
+  }
+
+  fhicl::ParameterSet ThresholdConfiguration()
+  {
+    fhicl::ParameterSet pset;
+    pset.put("StartADCThreshold", 3);
+    pset.put("EndADCThreshold", 2);
+    pset.put("NSigmaThresholdStart", 5);
+    pset.put("NSigmaThresholdEnd", 3);
+    return pset;
+  }
+
+  fhicl::ParameterSet SlidingWindowConfiguration()
+  {
+    fhicl::ParameterSet pset;
+    pset.put("PositivePolarity", true);
+    pset.put("NumPreSample", 3);
+    pset.put("ADCThreshold", 4);
+    pset.put("NSigmaThreshold", 4);
+    pset.put("EndADCThreshold", 2);
+    pset.put("EndNSigmaThreshold", 1);
+    pset.put("Verbosity", false);
+    return pset;
+  }
+
+  fhicl::ParameterSet FixedWindowConfiguration()
+  {
+    fhicl::ParameterSet pset;
+    pset.put("StartIndex", 0);
+    pset.put("EndIndex", 20);
+    return pset;
+  }
+
+  fhicl::ParameterSet CFDConfiguration()
+  {
+    fhicl::ParameterSet pset;
+    pset.put("Fraction", 0.9);
+    pset.put("Delay", 2);
+    pset.put("PeakThresh", 7.5);
+    pset.put("StartThresh", 5.0);
+    pset.put("EndThresh", 1.5);
+    return pset;
+  }
+
+  fhicl::ParameterSet SiPMConfiguration()
+  {
+    fhicl::ParameterSet pset;
+    pset.put("ADCThreshold", 13);
+    pset.put("MinWidth", 3);
+    pset.put("SecondThreshold", 1);
+    pset.put("Pedestal", Baseline);
+    return pset;
+  }
+
+  //----------------------------------------------------------------------------
+  /// Returns a function creating an algorithm of type `T` configured by `pset`.
+  template <typename T, typename Base>
+  std::function<std::unique_ptr<Base>()> Maker(fhicl::ParameterSet const& pset)
+  {
+    return [pset]() -> std::unique_ptr<Base> { return std::make_unique<T>(pset); };
+  }
+
+  //----------------------------------------------------------------------------
+  /// Whether the two pulse lists have the same pulses, with the same extent and area.
+  bool SamePulses(pmtana::pulse_param_array const& a, pmtana::pulse_param_array const& b)
+  {
+    return std::equal(a.begin(),
+                      a.end(),
+                      b.begin(),
+                      b.end(),
+                      [](pmtana::pulse_param const& pa, pmtana::pulse_param const& pb) {
+                        return pa.t_start == pb.t_start && pa.t_end == pb.t_end &&
+                               pa.area == pb.area;
+                      });
+  }
+
+  //----------------------------------------------------------------------------
+  void PrintResult(std::string const& name,
+                   double seconds,
+                   std::size_t nSamples,
+                   std::size_t nWaveforms,
+                   std::size_t nAllocations,
+                   std::size_t nResults,
+                   char const* resultName)
+  {
+    std::cout << std::left << std::setw(36) << name << std::right << std::fixed
+              << std::setprecision(1) << std::setw(10) << (nSamples / seconds / 1e6)
+              << " Msamples/s" << std::setprecision(2) << std::setw(10)
+              << (double(nAllocations) / nWaveforms) << " allocations/waveform " << std::setw(8)
+              << nResults << " " << resultName << std::endl;
+  }
+
+} // local namespace
+
+//------------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+  Config const config = ParseArguments(argc, argv);
+  auto const events = GenerateEvents(config);
+
+  using PedBase_t = pmtana::PMTPedestalBase;
+  using RecoBase_t = pmtana::PMTPulseRecoBase;
+
+  std::vector<std::pair<std::string, std::function<std::unique_ptr<PedBase_t>()>>> const
+    pedAlgos{
+      {"Edges", Maker<pmtana::PedAlgoEdges, PedBase_t>(EdgesConfiguration())},
+      {"RollingMean", Maker<pmtana::PedAlgoRollingMean, PedBase_t>(RollingMeanConfiguration())},
+      {"RmsSlider", Maker<pmtana::PedAlgoRmsSlider, PedBase_t>(RmsSliderConfiguration())},
+      {"UB", Maker<pmtana::PedAlgoUB, PedBase_t>(UBConfiguration())}};
+  std::vector<std::pair<std::string, std::function<std::unique_ptr<RecoBase_t>()>>> const
+    recoAlgos{
+      {"Threshold", Maker<pmtana::AlgoThreshold, RecoBase_t>(ThresholdConfiguration())},
+      {"SlidingWindow",
+       Maker<pmtana::AlgoSlidingWindow, RecoBase_t>(SlidingWindowConfiguration())},
+      {"FixedWindow", Maker<pmtana::AlgoFixedWindow, RecoBase_t>(FixedWindowConfiguration())},
+      {"CFD", Maker<pmtana::AlgoCFD, RecoBase_t>(CFDConfiguration())},
+      {"SiPM", Maker<pmtana::AlgoSiPM, RecoBase_t>(SiPMConfiguration())}};
+
+  std::size_t const nWaveforms = std::size_t(config.nEvents) * config.nChannels;
+  std::size_t const nSamples = nWaveforms * config.length;
+
+  std::cout << "Events: " << config.nEvents << ", channels: " << config.nChannels
+            << ", samples per waveform: " << config.length
+            << ", pulses per 1000 samples: " << config.rate << ", noise: " << config.noise
+            << " ADC" << std::endl;
+
+  bool success = true;
+
+  // pulses of each pulse algorithm with the first pedestal algorithm (see the shared pedestal)
+  std::vector<std::size_t> pulsesWithFirstPedestal;
+
+  //
+  // pulse reconstruction
+  //
+  for (auto const& [pedName, makePed] : pedAlgos) {
+    for (auto const& [recoName, makeReco] : recoAlgos) {
+      auto pedAlgo = makePed();
+      auto recoAlgo = makeReco();
+      pmtana::PulseRecoManager manager;
+      manager.AddRecoAlgo(recoAlgo.get());
+      manager.SetDefaultPedAlgo(pedAlgo.get());
+      manager.EnableStats(config.stats);
+
+      std::size_t nPulses = 0;
+
+      std::size_t const allocationsBefore = gAllocations;
+      auto const start = std::chrono::steady_clock::now();
+      for (unsigned int iEvent = 0; iEvent < config.nEvents; ++iEvent) {
+        for (auto const& waveform : events[iEvent]) {
+          manager.Reconstruct(waveform);
+          nPulses += recoAlgo->GetNPulse();
+        }
+      }
+      auto const stop = std::chrono::steady_clock::now();
+      std::size_t const nAllocations = gAllocations - allocationsBefore;
+
+      PrintResult(pedName + " + " + recoName,
+                  std::chrono::duration<double>(stop - start).count(),
+                  nSamples,
+                  nWaveforms,
+                  nAllocations,
+                  nPulses,
+                  "pulses");
+      if (config.stats) std::cout << manager.Stats() << std::endl;
+      if (pedName == pedAlgos.front().first) pulsesWithFirstPedestal.push_back(nPulses);
+
+      // skipping the quiet waveforms must not change any pulse
+      auto skipPedAlgo = makePed();
+      auto skipRecoAlgo = makeReco();
+      pmtana::PulseRecoManager skipManager;
+      skipManager.AddRecoAlgo(skipRecoAlgo.get());
+      skipManager.SetDefaultPedAlgo(skipPedAlgo.get());
+      skipManager.SetSkipQuietWaveforms(true);
+
+      std::size_t nDifferent = 0;
+      for (unsigned int iEvent = 0; iEvent < config.nEvents; ++iEvent) {
+        for (auto const& waveform : events[iEvent]) {
+          manager.Reconstruct(waveform);
+          skipManager.Reconstruct(waveform);
+          if (!SamePulses(recoAlgo->GetPulses(), skipRecoAlgo->GetPulses())) ++nDifferent;
+        }
+      }
+      if (nDifferent > 0) {
+        std::cerr << "ERROR: " << pedName << " + " << recoName << " finds different pulses in "
+                  << nDifferent << " waveforms when skipping the quiet ones" << std::endl;
+        success = false;
+      }
+    }
+  }
+
+  //
+  // all the pulse algorithms side by side, sharing a single pedestal evaluation
+  //
+  {
+    auto const& [pedName, makePed] = pedAlgos.front();
+    auto pedAlgo = makePed();
+    std::vector<std::unique_ptr<RecoBase_t>> recoAlgoPtrs;
+    pmtana::PulseRecoManager manager;
+    for (auto const& recoAlgo : recoAlgos) {
+      recoAlgoPtrs.push_back(recoAlgo.second());
+      manager.AddRecoAlgo(recoAlgoPtrs.back().get(), pedAlgo.get());
+    }
+    manager.EnableStats(config.stats);
+
+    std::vector<std::size_t> nAlgoPulses(recoAlgoPtrs.size(), 0);
+
+    std::size_t const allocationsBefore = gAllocations;
+    auto const start = std::chrono::steady_clock::now();
+    for (unsigned int iEvent = 0; iEvent < config.nEvents; ++iEvent) {
+      for (auto const& waveform : events[iEvent]) {
+        manager.Reconstruct(waveform);
+        for (std::size_t iAlgo = 0; iAlgo < recoAlgoPtrs.size(); ++iAlgo)
+          nAlgoPulses[iAlgo] += recoAlgoPtrs[iAlgo]->GetNPulse();
+      }
+    }
+    auto const stop = std::chrono::steady_clock::now();
+    std::size_t const nAllocations = gAllocations - allocationsBefore;
+    std::size_t const nPulses =
+      std::accumulate(nAlgoPulses.begin(), nAlgoPulses.end(), std::size_t{0});
+
+    PrintResult(pedName + " + all (shared pedestal)",
+                std::chrono::duration<double>(stop - start).count(),
+                nSamples,
+                nWaveforms,
+                nAllocations,
+                nPulses,
+                "pulses");
+    if (config.stats) std::cout << manager.Stats() << std::endl;
+
+    // sharing the pedestal must not change the pulses of any algorithm
+    for (std::size_t iAlgo = 0; iAlgo < recoAlgos.size(); ++iAlgo) {
+      if (nAlgoPulses[iAlgo] == pulsesWithFirstPedestal[iAlgo]) continue;
+      std::cerr << "ERROR: " << recoAlgos[iAlgo].first << " finds " << nAlgoPulses[iAlgo]
+                << " pulses on the shared " << pedName << " pedestal, but "
+                << pulsesWithFirstPedestal[iAlgo] << " on its own" << std::endl;
+      success = false;
+    }
+  }
+
+  //
+  // flash clustering, on the hits from a sliding window reconstruction
+  //
+  std::vector<std::vector<recob::OpHit>> hits(config.nEvents);
+  {
+    pmtana::PedAlgoEdges pedAlgo(EdgesConfiguration());
+    pmtana::AlgoSlidingWindow recoAlgo(SlidingWindowConfiguration());
+    pmtana::PulseRecoManager manager;
+    manager.AddRecoAlgo(&recoAlgo);
+    manager.SetDefaultPedAlgo(&pedAlgo);
+    for (unsigned int iEvent = 0; iEvent < config.nEvents; ++iEvent) {
+      for (auto const& waveform : events[iEvent]) {
+        manager.Reconstruct(waveform);
+        for (auto const& pulse : recoAlgo.GetPulses()) {
+          double const time = waveform.TimeStamp() + pulse.t_max * TickPeriod;
+          double const width = (pulse.t_end - pulse.t_start) * TickPeriod;
+          double const PE = pulse.area / AreaPerPE;
+          hits[iEvent].emplace_back(
+            waveform.ChannelNumber(), time, time, 0, width, pulse.area, pulse.peak, PE, 0.0);
+        }
+      }
+    }
+  }
+
+  constexpr double BinWidth = 0.01;     // us
+  constexpr float FlashThreshold = 2.0; // PE
+  constexpr float WidthTolerance = 0.5;
+  opdet::FlashFinderScratch scratch;
+  std::vector<std::vector<int>> refinedHitsPerFlash;
+  std::size_t nHits = 0, nFlashes = 0;
+
+  std::size_t const allocationsBefore = gAllocations;
+  auto const start = std::chrono::steady_clock::now();
+  for (auto const& eventHits : hits) {
+    nHits += eventHits.size();
+    if (eventHits.empty()) continue;
+    double minTime = std::numeric_limits<float>::max();
+    for (auto const& hit : eventHits)
+      minTime = std::min(minTime, hit.PeakTime());
+
+    opdet::FillAccumulator(
+      eventHits, minTime, BinWidth, 0.0, FlashThreshold, scratch.Accumulators[0]);
+    opdet::FillAccumulator(
+      eventHits, minTime, BinWidth, BinWidth / 2.0, FlashThreshold, scratch.Accumulators[1]);
+    opdet::AssignHitsToFlash(eventHits, FlashThreshold, scratch);
+
+    refinedHitsPerFlash.clear();
+    scratch.HitsUsed.assign(eventHits.size(), false);
+    for (std::size_t iFlash = 0; iFlash + 1 < scratch.FlashHitStart.size(); ++iFlash)
+      opdet::RefineHitsInFlash(scratch.FlashHits.data() + scratch.FlashHitStart[iFlash],
+                               scratch.FlashHits.data() + scratch.FlashHitStart[iFlash + 1],
+                               eventHits,
+                               refinedHitsPerFlash,
+                               WidthTolerance,
+                               FlashThreshold,
+                               scratch);
+    nFlashes += refinedHitsPerFlash.size();
+  }
+  auto const stop = std::chrono::steady_clock::now();
+  std::size_t const nAllocations = gAllocations - allocationsBefore;
+
+  double const seconds = std::chrono::duration<double>(stop - start).count();
+  std::cout << std::left << std::setw(36) << "Flash clustering" << std::right << std::fixed
+            << std::setprecision(2) << std::setw(10) << (nHits / seconds / 1e6)
+            << " Mhits/s    " << std::setw(10) << (double(nAllocations) / config.nEvents)
+            << " allocations/event    " << std::setw(8) << nFlashes << " flashes from "
+            << nHits << " hits" << std::endl;
+
+  return success ? 0 : 1;
+}
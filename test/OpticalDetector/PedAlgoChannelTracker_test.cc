@@ -0,0 +1,142 @@
+/**
+ * @file   PedAlgoChannelTracker_test.cc
+ * @brief  Checks the tracked, full estimate and reset paths of `PedAlgoChannelTracker`,
+ *         and that the tracked pedestal sigma is not biased.
+ */
+
+#define BOOST_TEST_MODULE (PedAlgoChannelTracker_test)
+#include "boost/test/unit_test.hpp"
+
+#include "larana/OpticalDetector/OpHitFinder/PedAlgoChannelTracker.h"
+#include "larana/OpticalDetector/OpHitFinder/PedAlgoEdges.h"
+
+#include "fhiclcpp/ParameterSet.h"
+
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+  fhicl::ParameterSet edgesConfig()
+  {
+    fhicl::ParameterSet pset;
+    pset.put("Name", std::string("Edges"));
+    pset.put("NumSampleFront", 3);
+    pset.put("NumSampleTail", 3);
+    pset.put("Method", 0);
+    return pset;
+  }
+
+  fhicl::ParameterSet trackerConfig(bool acrossEvents = false)
+  {
+    fhicl::ParameterSet pset;
+    pset.put("FullEstimateAlgo", edgesConfig());
+    pset.put("CheckSamples", 3);
+    pset.put("MaxDeviation", 2.0);
+    pset.put("NSigmaDeviation", 3.0);
+    pset.put("UpdateWeight", 0.5);
+    pset.put("TrackAcrossEvents", acrossEvents);
+    return pset;
+  }
+
+  pmtana::Waveform_t flatWaveform(short level, std::size_t size = 20)
+  {
+    return pmtana::Waveform_t(size, level);
+  }
+
+}
+
+BOOST_AUTO_TEST_CASE(TrackAndFullEstimate_test)
+{
+  pmtana::PedAlgoChannelTracker tracker(trackerConfig());
+  tracker.SetChannel(4);
+
+  // first fragment of the channel: full estimate
+  auto wf = flatWaveform(2000);
+  wf[0] = 2002;
+  wf[2] = 1998;
+  BOOST_TEST(tracker.Evaluate(wf));
+  BOOST_TEST(tracker.NFullEstimates() == 1U);
+  BOOST_TEST(tracker.NTrackedEstimates() == 0U);
+  double const fullMean = tracker.Mean(0);
+
+  // agreeing fragment: tracked baseline, moved toward the new head mean
+  auto const wf2 = flatWaveform(2001);
+  BOOST_TEST(tracker.Evaluate(wf2));
+  BOOST_TEST(tracker.NFullEstimates() == 1U);
+  BOOST_TEST(tracker.NTrackedEstimates() == 1U);
+  BOOST_TEST(tracker.Model().IsConstant());
+  BOOST_TEST(std::abs(tracker.Mean(10) - (fullMean + 0.5 * (2001. - fullMean))) < 1e-9);
+
+  // disagreeing fragment: full estimate, equal to the one of the full estimate algorithm
+  auto const wf3 = flatWaveform(2050);
+  pmtana::PedAlgoEdges edges(edgesConfig());
+  edges.Evaluate(wf3);
+  BOOST_TEST(tracker.Evaluate(wf3));
+  BOOST_TEST(tracker.NFullEstimates() == 2U);
+  BOOST_TEST(tracker.Mean(0) == edges.Mean(0));
+  BOOST_TEST(tracker.Sigma(0) == edges.Sigma(0));
+
+  // another channel has no baseline yet
+  tracker.SetChannel(5);
+  BOOST_TEST(tracker.Evaluate(wf3));
+  BOOST_TEST(tracker.NFullEstimates() == 3U);
+}
+
+BOOST_AUTO_TEST_CASE(NewEventReset_test)
+{
+  auto const wf = flatWaveform(2000);
+
+  pmtana::PedAlgoChannelTracker tracker(trackerConfig());
+  tracker.SetChannel(1);
+  tracker.Evaluate(wf);
+  tracker.Evaluate(wf);
+  BOOST_TEST(tracker.NTrackedEstimates() == 1U);
+
+  // baselines are forgotten at a new event...
+  tracker.NewEvent();
+  tracker.Evaluate(wf);
+  BOOST_TEST(tracker.NFullEstimates() == 2U);
+  BOOST_TEST(tracker.NTrackedEstimates() == 1U);
+
+  // ... unless they are tracked across events
+  pmtana::PedAlgoChannelTracker keeper(trackerConfig(true));
+  keeper.SetChannel(1);
+  keeper.Evaluate(wf);
+  keeper.NewEvent();
+  keeper.Evaluate(wf);
+  BOOST_TEST(keeper.NFullEstimates() == 1U);
+  BOOST_TEST(keeper.NTrackedEstimates() == 1U);
+}
+
+BOOST_AUTO_TEST_CASE(UnbiasedSigma_test)
+{
+  constexpr double Sigma = 3.0;
+  auto config = trackerConfig();
+  config.put_or_replace("UpdateWeight", 0.01);
+  config.put_or_replace("MaxDeviation", 100.0);
+  pmtana::PedAlgoChannelTracker tracker(config);
+  tracker.SetChannel(0);
+
+  std::mt19937 gen(42);
+  std::normal_distribution<double> noise(2000., Sigma);
+  double sumSigma = 0.;
+  int nSigma = 0;
+  for (int i = 0; i < 20000; ++i) {
+    pmtana::Waveform_t wf(20);
+    for (auto& sample : wf)
+      sample = static_cast<short>(std::lround(noise(gen)));
+    tracker.Evaluate(wf);
+    if (i >= 2000) {
+      sumSigma += tracker.Sigma(0);
+      ++nSigma;
+    }
+  }
+
+  BOOST_TEST(tracker.NFullEstimates() == 1U);
+  // the ADC rounding adds 1/12 to the variance; a biased estimator would be ~18% low
+  double const expected = std::sqrt(Sigma * Sigma + 1. / 12.);
+  BOOST_TEST(std::abs(sumSigma / nSigma - expected) < 0.05 * expected);
+}
@@ -0,0 +1,48 @@
+/**
+ * @file   PedestalAlgos_test.cc
+ * @brief  Regression tests of the pedestal estimation helpers and algorithms
+ *         on edge cases of their input.
+ */
+
+#define BOOST_TEST_MODULE (PedestalAlgos_test)
+#include "boost/test/unit_test.hpp"
+
+#include "larana/OpticalDetector/OpHitFinder/PedAlgoRmsSlider.h"
+#include "larana/OpticalDetector/OpHitFinder/UtilFunc.h"
+
+#include "fhiclcpp/ParameterSet.h"
+
+#include <cmath>
+#include <vector>
+
+BOOST_AUTO_TEST_CASE(BinnedMaxOccurrence_maximumInLastBin)
+{
+  // the most frequent value is the maximum, which used to be counted one past the last bin
+  std::vector<double> const values{0., 1., 2., 10., 10., 10.};
+
+  double const mode = pmtana::BinnedMaxOccurrence(values, 5);
+
+  BOOST_TEST(mode == 9.); // center of the last bin, [ 8, 10 ]
+}
+
+BOOST_AUTO_TEST_CASE(RmsSlider_noisyFirstWindow)
+{
+  fhicl::ParameterSet pset;
+  pset.put("SampleSize", 7);
+  pset.put("Threshold", 0.6);
+  pset.put("NumPostSample", 10);
+  pset.put("Verbose", false);
+  pset.put("NWaveformsToFile", 0);
+  pmtana::PedAlgoRmsSlider algo(pset);
+
+  // noise at the start of the waveform: the first windows are not good pedestal,
+  // and the gap before the first good one used to be interpolated from index -1
+  constexpr short Baseline = 2000;
+  pmtana::Waveform_t wf(200, Baseline);
+  for (size_t i = 0; i < 12; ++i)
+    wf[i] += (i % 2) ? 10 : -10;
+
+  BOOST_TEST(algo.Evaluate(wf));
+  for (size_t i = 0; i < wf.size(); ++i)
+    BOOST_TEST(std::abs(algo.Mean(i) - Baseline) < 1.0, "sample " << i);
+}
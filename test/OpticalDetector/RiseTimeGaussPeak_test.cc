@@ -0,0 +1,132 @@
+/**
+ * @file   RiseTimeGaussPeak_test.cc
+ * @brief  Checks the closed-form Gaussian peak estimator of `RiseTimeGaussPeak`
+ *         on simulated Gaussian pulses.
+ */
+
+#define BOOST_TEST_MODULE (RiseTimeGaussPeak_test)
+#include "boost/test/unit_test.hpp"
+
+#include "larana/OpticalDetector/OpHitFinder/RiseTimeTools/GaussPeakEstimator.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace {
+
+  constexpr double MinAmp = 4.0;
+  constexpr int Nbins = 3;
+  constexpr double Pedestal = 2000.;
+
+  /// Gaussian pulse of the given polarity on a flat pedestal, with optional noise.
+  pmtana::Waveform_t makePulse(double mean,
+                               double sigma,
+                               double amp,
+                               bool positive,
+                               double noise,
+                               std::mt19937& rng,
+                               std::size_t size = 40)
+  {
+    std::normal_distribution<double> gaus(0., noise);
+    pmtana::Waveform_t wf(size);
+    for (std::size_t i = 0; i < size; ++i) {
+      double const signal = amp * std::exp(-0.5 * std::pow((i - mean) / sigma, 2));
+      wf[i] = short(
+        std::lround(Pedestal + (positive ? signal : -signal) + (noise > 0. ? gaus(rng) : 0.)));
+    }
+    return wf;
+  }
+
+} // local namespace
+
+BOOST_AUTO_TEST_SUITE(RiseTimeGaussPeak_test)
+
+BOOST_AUTO_TEST_CASE(FirstLocalMax_test)
+{
+  pmtana::Waveform_t const wf{2000, 2002, 2006, 2010, 2008, 2012, 2003};
+  pmtana::PedestalMean_t const ped(wf.size(), Pedestal);
+
+  bool found = false;
+  BOOST_TEST(pmtana::FirstLocalMax(wf, ped, true, MinAmp, found) == 3u);
+  BOOST_TEST(found);
+
+  // the first maximum is below threshold, the next one is taken
+  BOOST_TEST(pmtana::FirstLocalMax(wf, ped, true, 11., found) == 5u);
+  BOOST_TEST(found);
+
+  BOOST_TEST(pmtana::FirstLocalMax(wf, ped, true, 20., found) == 0u);
+  BOOST_TEST(!found);
+
+  // negative polarity: no signal at all
+  BOOST_TEST(pmtana::FirstLocalMax(wf, ped, false, MinAmp, found) == 0u);
+  BOOST_TEST(!found);
+}
+
+BOOST_AUTO_TEST_CASE(GaussPeakPosition_noiseless)
+{
+  std::mt19937 rng(1234);
+  pmtana::PedestalMean_t const ped(40, Pedestal);
+
+  for (bool positive : {true, false}) {
+    for (double mean : {10.0, 10.25, 10.5, 10.8, 17.33}) {
+      for (double sigma : {1.5, 3.0, 6.0}) {
+        auto const wf = makePulse(mean, sigma, 8000., positive, 0., rng);
+
+        bool found = false;
+        std::size_t const first_max = pmtana::FirstLocalMax(wf, ped, positive, MinAmp, found);
+        BOOST_TEST_REQUIRE(found);
+
+        double const t = pmtana::GaussPeakPosition(wf, ped, positive, first_max, Nbins);
+        BOOST_TEST(std::abs(t - mean) < 0.01);
+
+        // three-point interpolation is also exact
+        double const t3 = pmtana::GaussPeakPosition(wf, ped, positive, first_max, 1);
+        BOOST_TEST(std::abs(t3 - mean) < 0.01);
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(GaussPeakPosition_noisy)
+{
+  std::mt19937 rng(98765);
+  std::uniform_real_distribution<double> flat(0., 1.);
+  pmtana::PedestalMean_t const ped(40, Pedestal);
+
+  for (int iPulse = 0; iPulse < 200; ++iPulse) {
+    bool const positive = (iPulse % 2) == 0;
+    double const mean = 20. + flat(rng);
+    double const sigma = 2. + 4. * flat(rng);
+    double const amp = 100. + 200. * flat(rng);
+    auto const wf = makePulse(mean, sigma, amp, positive, 1., rng);
+
+    // the search of the first maximum is itself sensitive to noise on the rising edge;
+    // start from the sample closest to the true peak to check the estimator alone
+    std::size_t const imax = std::lround(mean);
+    double const t = pmtana::GaussPeakPosition(wf, ped, positive, imax, Nbins);
+    BOOST_TEST_CONTEXT("pulse #" << iPulse << " mean=" << mean << " sigma=" << sigma
+                                 << " amp=" << amp)
+    {
+      BOOST_TEST(std::abs(t - mean) < 0.5);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(GaussPeakPosition_failures)
+{
+  pmtana::PedestalMean_t const ped(5, Pedestal);
+
+  // not enough positive samples
+  pmtana::Waveform_t const spike{2000, 2000, 2010, 2000, 2000};
+  BOOST_TEST(std::isnan(pmtana::GaussPeakPosition(spike, ped, true, 2, Nbins)));
+
+  // a dip, not a peak
+  pmtana::Waveform_t const dip{2016, 2004, 2001, 2004, 2016};
+  BOOST_TEST(std::isnan(pmtana::GaussPeakPosition(dip, ped, true, 2, Nbins)));
+
+  // out of range
+  BOOST_TEST(std::isnan(pmtana::GaussPeakPosition(dip, ped, true, 5, Nbins)));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
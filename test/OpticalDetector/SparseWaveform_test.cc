@@ -0,0 +1,99 @@
+/**
+ * @file   SparseWaveform_test.cc
+ * @brief  Checks `opdet::SparseWaveform` against the dense waveform buffers
+ *         it replaces in the optical digitizers.
+ */
+
+#define BOOST_TEST_MODULE (SparseWaveform_test)
+#include "boost/test/unit_test.hpp"
+
+#include "larana/OpticalDetector/SparseWaveform.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace {
+
+  /// Same as `OptDetDigitizer::AddWaveform()` on a dense buffer.
+  void addDense(std::size_t time,
+                std::vector<double>& wf,
+                std::vector<double> const& shape,
+                double factor,
+                bool extend)
+  {
+    if ((time + shape.size()) > wf.size() && extend) wf.resize(time + shape.size());
+    for (std::size_t i = 0; i < shape.size() && (time + i) < wf.size(); ++i)
+      wf[time + i] += shape[i] * factor;
+  }
+
+  std::vector<double> pulseShape()
+  {
+    std::vector<double> shape(25);
+    for (std::size_t i = 0; i < shape.size(); ++i)
+      shape[i] = i * std::exp(-0.4 * i);
+    return shape;
+  }
+
+}
+
+BOOST_AUTO_TEST_CASE(MergeRegions_test)
+{
+  std::vector<double> const shape(10, 1.0);
+  opdet::SparseWaveform wf(100);
+
+  wf.AddPulse(10, shape);
+  wf.AddPulse(50, shape);
+  BOOST_TEST(wf.Regions().size() == 2U);
+  BOOST_TEST(wf.NStoredSamples() == 20U);
+
+  // adjacent to the first region, overlapping the second one
+  wf.AddPulse(20, shape);
+  wf.AddPulse(45, shape, 2.0);
+  BOOST_TEST(wf.Regions().size() == 2U);
+  BOOST_TEST(wf.Regions()[0].start == 10U);
+  BOOST_TEST(wf.Regions()[0].samples.size() == 20U);
+  BOOST_TEST(wf.Regions()[1].start == 45U);
+  BOOST_TEST(wf.Regions()[1].samples.size() == 15U);
+  BOOST_TEST(wf.Sample(52) == 3.0);
+
+  // bridging both regions, and truncated at the end of the waveform
+  wf.AddPulse(25, std::vector<double>(25, 1.0));
+  wf.AddPulse(95, shape);
+  BOOST_TEST(wf.Regions().size() == 2U);
+  BOOST_TEST(wf.Regions()[0].samples.size() == 50U);
+  BOOST_TEST(wf.Regions()[1].samples.size() == 5U);
+  BOOST_TEST(wf.Sample(5) == 0.0);
+  BOOST_TEST(wf.Sample(27) == 2.0);
+}
+
+BOOST_AUTO_TEST_CASE(DenseEquivalence_test)
+{
+  std::vector<double> const shape = pulseShape();
+  std::mt19937 gen(1234);
+
+  for (int trial = 0; trial < 500; ++trial) {
+    std::size_t const size = 200 + gen() % 400;
+    opdet::SparseWaveform sparse(size);
+    std::vector<double> dense(size, 0.0);
+
+    int const nPulses = gen() % 30;
+    for (int i = 0; i < nPulses; ++i) {
+      std::size_t const time = gen() % (size + 40);
+      double const factor = 1.0 + gen() % 4;
+      bool const extend = (gen() % 4 == 0);
+      addDense(time, dense, shape, factor, extend);
+      sparse.AddPulse(time, shape, factor, extend);
+      if (gen() % 8 == 0) {
+        std::size_t const newSize = 1 + gen() % (dense.size() + 20);
+        dense.resize(newSize);
+        sparse.resize(newSize);
+      }
+    }
+
+    std::vector<double> filled;
+    sparse.Fill(filled);
+    BOOST_TEST(filled == dense);
+    BOOST_TEST(sparse.NStoredSamples() <= dense.size());
+  }
+}